@@ -0,0 +1,209 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  Activation.cxx
+ *  @brief Activation functions of PMML neural layers
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/Activation.hxx"
+#include "otpmml/ActivationKernels.hxx"
+
+#include <openturns/Log.hxx>
+#include <openturns/Exception.hxx>
+
+#include <cmath>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+/* Get activation type from its PMML name */
+Activation::Type Activation::GetTypeFromName(const String & name)
+{
+  if (name == "tanh") return TANH;
+  if (name == "logistic") return LOGISTIC;
+  if (name == "exponential") return EXPONENTIAL;
+  if (name == "reciprocal") return RECIPROCAL;
+  if (name == "square") return SQUARE;
+  if (name == "Gauss") return GAUSS;
+  if (name == "sine") return SINE;
+  if (name == "cosine") return COSINE;
+  if (name == "Elliott") return ELLIOTT;
+  if (name == "arctan") return ARCTAN;
+  if (name != "identity")
+    LOGERROR(OSS() << "Unknown activation function: " << name);
+  return IDENTITY;
+}
+
+/* Get PMML name of an activation type */
+String Activation::GetName(const UnsignedInteger type)
+{
+  switch (type)
+  {
+    case IDENTITY:
+      return "identity";
+    case TANH:
+      return "tanh";
+    case LOGISTIC:
+      return "logistic";
+    case EXPONENTIAL:
+      return "exponential";
+    case RECIPROCAL:
+      return "reciprocal";
+    case SQUARE:
+      return "square";
+    case GAUSS:
+      return "Gauss";
+    case SINE:
+      return "sine";
+    case COSINE:
+      return "cosine";
+    case ELLIOTT:
+      return "Elliott";
+    case ARCTAN:
+      return "arctan";
+    default:
+      throw InvalidArgumentException(HERE) << "Unknown activation type " << type;
+  }
+}
+
+/* Evaluate activation function at a given point */
+Scalar Activation::Evaluate(const UnsignedInteger type, const Scalar x)
+{
+  switch (type)
+  {
+    case TANH:
+      return std::tanh(x);
+    case LOGISTIC:
+      return 1.0 / (1.0 + std::exp(-x));
+    case EXPONENTIAL:
+      return std::exp(x);
+    case RECIPROCAL:
+      return 1.0 / x;
+    case SQUARE:
+      return x * x;
+    case GAUSS:
+      return std::exp(-x * x);
+    case SINE:
+      return std::sin(x);
+    case COSINE:
+      return std::cos(x);
+    case ELLIOTT:
+      return x / (1.0 + std::abs(x));
+    case ARCTAN:
+      // Same as 0.5*atan(x)/atan(1), ie 2*atan(x)/pi
+      return 0.5 * std::atan(x) / std::atan(1.0);
+    default:
+      return x;
+  }
+}
+
+/* Evaluate the derivative of an activation function at a given point */
+Scalar Activation::Derivative(const UnsignedInteger type, const Scalar x)
+{
+  switch (type)
+  {
+    case TANH:
+    {
+      const Scalar value = std::tanh(x);
+      return 1.0 - value * value;
+    }
+    case LOGISTIC:
+    {
+      const Scalar value = 1.0 / (1.0 + std::exp(-x));
+      return value * (1.0 - value);
+    }
+    case EXPONENTIAL:
+      return std::exp(x);
+    case RECIPROCAL:
+      return -1.0 / (x * x);
+    case SQUARE:
+      return 2.0 * x;
+    case GAUSS:
+      return -2.0 * x * std::exp(-x * x);
+    case SINE:
+      return std::cos(x);
+    case COSINE:
+      return -std::sin(x);
+    case ELLIOTT:
+    {
+      const Scalar denominator = 1.0 + std::abs(x);
+      return 1.0 / (denominator * denominator);
+    }
+    case ARCTAN:
+      return 0.5 / (std::atan(1.0) * (1.0 + x * x));
+    default:
+      return 1.0;
+  }
+}
+
+/* Evaluate the second derivative of an activation function at a given point */
+Scalar Activation::SecondDerivative(const UnsignedInteger type, const Scalar x)
+{
+  switch (type)
+  {
+    case TANH:
+    {
+      const Scalar value = std::tanh(x);
+      return -2.0 * value * (1.0 - value * value);
+    }
+    case LOGISTIC:
+    {
+      const Scalar value = 1.0 / (1.0 + std::exp(-x));
+      return value * (1.0 - value) * (1.0 - 2.0 * value);
+    }
+    case EXPONENTIAL:
+      return std::exp(x);
+    case RECIPROCAL:
+      return 2.0 / (x * x * x);
+    case SQUARE:
+      return 2.0;
+    case GAUSS:
+      return (4.0 * x * x - 2.0) * std::exp(-x * x);
+    case SINE:
+      return -std::sin(x);
+    case COSINE:
+      return -std::cos(x);
+    case ELLIOTT:
+    {
+      const Scalar denominator = 1.0 + std::abs(x);
+      return (x > 0.0 ? -2.0 : (x < 0.0 ? 2.0 : 0.0)) / (denominator * denominator * denominator);
+    }
+    case ARCTAN:
+    {
+      const Scalar denominator = 1.0 + x * x;
+      return -x / (std::atan(1.0) * denominator * denominator);
+    }
+    default:
+      return 0.0;
+  }
+}
+
+/* Evaluate activation function in place on an array of values */
+void Activation::Evaluate(const UnsignedInteger type, Scalar * values, const UnsignedInteger size)
+{
+  ActivationKernels::Evaluate(type, values, size);
+}
+
+void Activation::Evaluate(const UnsignedInteger type, float * values, const UnsignedInteger size)
+{
+  ActivationKernels::Evaluate(type, values, size);
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,208 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ActivationKernels.cxx
+ *  @brief Vectorized activation functions of PMML neural layers
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/ActivationKernels.hxx"
+#include "otpmml/Activation.hxx"
+
+#include <openturns/Exception.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// Kernels rely on GCC vector extensions and #pragma GCC target
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define OTPMML_X86_KERNELS
+// On Windows, GCC does not realign the stack for 32 and 64 byte vector spills
+// (GCC bug 54412), so the AVX2 and AVX-512 kernels could fault
+#ifndef _WIN32
+#define OTPMML_WIDE_X86_KERNELS
+#endif
+#endif
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+#ifdef OTPMML_X86_KERNELS
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#define OTPMML_KERNELS_NAMESPACE SSE2Kernels
+#define OTPMML_KERNELS_WIDTH 2
+#include "ActivationKernelsBody.hxx"
+#undef OTPMML_KERNELS_WIDTH
+#undef OTPMML_KERNELS_NAMESPACE
+#pragma GCC pop_options
+
+#ifdef OTPMML_WIDE_X86_KERNELS
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#define OTPMML_KERNELS_NAMESPACE AVX2Kernels
+#define OTPMML_KERNELS_WIDTH 4
+#include "ActivationKernelsBody.hxx"
+#undef OTPMML_KERNELS_WIDTH
+#undef OTPMML_KERNELS_NAMESPACE
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#define OTPMML_KERNELS_NAMESPACE AVX512Kernels
+#define OTPMML_KERNELS_WIDTH 8
+#include "ActivationKernelsBody.hxx"
+#undef OTPMML_KERNELS_WIDTH
+#undef OTPMML_KERNELS_NAMESPACE
+#pragma GCC pop_options
+#endif /* OTPMML_WIDE_X86_KERNELS */
+
+#endif /* OTPMML_X86_KERNELS */
+
+/* Evaluate activation function in place, one value at a time */
+static void EvaluateScalarKernel(const UnsignedInteger type, Scalar * values, const UnsignedInteger size)
+{
+  // Dispatch once, so that each loop has a single body
+  switch (type)
+  {
+    case Activation::IDENTITY:
+      break;
+    case Activation::TANH:
+      for (UnsignedInteger i = 0; i < size; ++i) values[i] = std::tanh(values[i]);
+      break;
+    case Activation::LOGISTIC:
+      for (UnsignedInteger i = 0; i < size; ++i) values[i] = 1.0 / (1.0 + std::exp(-values[i]));
+      break;
+    case Activation::SQUARE:
+      for (UnsignedInteger i = 0; i < size; ++i) values[i] *= values[i];
+      break;
+    default:
+      for (UnsignedInteger i = 0; i < size; ++i) values[i] = Activation::Evaluate(type, values[i]);
+  }
+}
+
+/* Detect the widest instruction set supported by the processor */
+static ActivationKernels::InstructionSet DetectInstructionSet()
+{
+#ifdef OTPMML_X86_KERNELS
+  __builtin_cpu_init();
+#ifdef OTPMML_WIDE_X86_KERNELS
+  if (__builtin_cpu_supports("avx512f"))
+    return ActivationKernels::AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return ActivationKernels::AVX2;
+#endif
+  if (__builtin_cpu_supports("sse2"))
+    return ActivationKernels::SSE2;
+#endif
+  return ActivationKernels::SCALAR;
+}
+
+/* Instruction set used by Evaluate */
+static std::atomic<int> & CurrentInstructionSet()
+{
+  static std::atomic<int> instructionSet(ActivationKernels::GetSupportedInstructionSet());
+  return instructionSet;
+}
+
+/* Evaluate activation function in place on an array of values */
+void ActivationKernels::Evaluate(const UnsignedInteger type, Scalar * values, const UnsignedInteger size)
+{
+  if (type == Activation::IDENTITY) return;
+  switch (CurrentInstructionSet().load(std::memory_order_relaxed))
+  {
+#ifdef OTPMML_X86_KERNELS
+#ifdef OTPMML_WIDE_X86_KERNELS
+    case AVX512:
+      AVX512Kernels::Evaluate(type, values, size);
+      break;
+    case AVX2:
+      AVX2Kernels::Evaluate(type, values, size);
+      break;
+#endif
+    case SSE2:
+      SSE2Kernels::Evaluate(type, values, size);
+      break;
+#endif
+    default:
+      EvaluateScalarKernel(type, values, size);
+  }
+}
+
+/* Number of single precision values converted at once by Evaluate */
+static const UnsignedInteger ActivationKernelsSinglePrecisionChunkSize = 256;
+
+/* Evaluate activation function in place on an array of single precision values */
+void ActivationKernels::Evaluate(const UnsignedInteger type, float * values, const UnsignedInteger size)
+{
+  if (type == Activation::IDENTITY) return;
+  // Activations are cheap compared to the layer products, so they are computed
+  // by the double precision kernels on small chunks which stay in cache
+  Scalar buffer[ActivationKernelsSinglePrecisionChunkSize];
+  for (UnsignedInteger i = 0; i < size; i += ActivationKernelsSinglePrecisionChunkSize)
+  {
+    const UnsignedInteger length = std::min(ActivationKernelsSinglePrecisionChunkSize, size - i);
+    std::copy(values + i, values + i + length, buffer);
+    Evaluate(type, buffer, length);
+    std::copy(buffer, buffer + length, values + i);
+  }
+}
+
+/* Widest instruction set supported by the processor */
+ActivationKernels::InstructionSet ActivationKernels::GetSupportedInstructionSet()
+{
+  static const InstructionSet supported = DetectInstructionSet();
+  return supported;
+}
+
+/* Instruction set used by Evaluate */
+ActivationKernels::InstructionSet ActivationKernels::GetInstructionSet()
+{
+  return static_cast<InstructionSet>(CurrentInstructionSet().load());
+}
+
+void ActivationKernels::SetInstructionSet(const InstructionSet instructionSet)
+{
+  if (instructionSet > GetSupportedInstructionSet())
+    throw InvalidArgumentException(HERE) << "Error: instruction set " << GetInstructionSetName(instructionSet) << " is not supported, the widest supported one is " << GetInstructionSetName(GetSupportedInstructionSet());
+  CurrentInstructionSet().store(instructionSet);
+}
+
+/* Name of an instruction set */
+String ActivationKernels::GetInstructionSetName(const UnsignedInteger instructionSet)
+{
+  switch (instructionSet)
+  {
+    case SCALAR:
+      return "scalar";
+    case SSE2:
+      return "SSE2";
+    case AVX2:
+      return "AVX2";
+    case AVX512:
+      return "AVX-512";
+    default:
+      throw InvalidArgumentException(HERE) << "Unknown instruction set " << instructionSet;
+  }
+}
+
+} /* namespace OTPMML */
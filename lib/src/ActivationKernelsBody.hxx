@@ -0,0 +1,341 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ActivationKernelsBody.hxx
+ *  @brief Vectorized activation kernels, compiled once per instruction set
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+// This file is not a regular header: it is included by ActivationKernels.cxx
+// once per instruction set, inside a #pragma GCC target region, with
+// OTPMML_KERNELS_NAMESPACE and OTPMML_KERNELS_WIDTH (number of doubles
+// per register) defined.  Kernels are written with GCC vector extensions,
+// so that the same source is compiled to SSE2, AVX2 or AVX-512 code.
+// Polynomial approximations are those of the Cephes library.
+
+namespace OTPMML_KERNELS_NAMESPACE
+{
+
+typedef double Pack __attribute__((vector_size(OTPMML_KERNELS_WIDTH * 8)));
+typedef __typeof__(Pack() < Pack()) IntPack;
+
+static const UnsignedInteger Width = OTPMML_KERNELS_WIDTH;
+
+inline Pack Broadcast(const double x)
+{
+  return Pack{} + x;
+}
+
+inline Pack Load(const Scalar * p)
+{
+  Pack x;
+  std::memcpy(&x, p, sizeof(Pack));
+  return x;
+}
+
+inline void Store(Scalar * p, const Pack x)
+{
+  std::memcpy(p, &x, sizeof(Pack));
+}
+
+inline Pack Abs(const Pack x)
+{
+  return (Pack)((IntPack)x & 0x7fffffffffffffffLL);
+}
+
+/* Copy the sign of y onto |x| */
+inline Pack CopySign(const Pack x, const Pack y)
+{
+  return (Pack)(((IntPack)x & 0x7fffffffffffffffLL) | ((IntPack)y & (long long)0x8000000000000000ULL));
+}
+
+/* Exponential; clamped arguments give 0 or +inf, NaN is propagated */
+inline Pack Exp(const Pack x)
+{
+  const Pack magic = Broadcast(6755399441055744.0);
+  Pack xc = x < -750.0 ? Broadcast(-750.0) : x;
+  xc = xc > 710.0 ? Broadcast(710.0) : xc;
+  // x = n ln2 + r, |r| <= ln2 / 2
+  const Pack t = xc * 1.4426950408889634073599 + magic;
+  const Pack n = t - magic;
+  const IntPack exponent = (IntPack)t - (IntPack)magic;
+  const Pack r = (xc - n * 6.93145751953125E-1) - n * 1.42860682030941723212E-6;
+  // Pade approximation of exp(r)
+  const Pack rr = r * r;
+  const Pack px = r * ((1.26177193074810590878E-4 * rr + 3.02994407707441961300E-2) * rr + 9.99999999999999999910E-1);
+  const Pack qx = ((3.00198505138664455042E-6 * rr + 2.52448340349684104192E-3) * rr + 2.27265548208155028766E-1) * rr + 2.00000000000000000009E0;
+  Pack result = 1.0 + 2.0 * (px / (qx - px));
+  // Multiply by 2^n in two steps, so that subnormal and infinite results are reached
+  const IntPack half = exponent >> 1;
+  result = result * (Pack)((half + 1023) << 52) * (Pack)((exponent - half + 1023) << 52);
+  return x != x ? x : result;
+}
+
+inline Pack Tanh(const Pack x)
+{
+  const Pack a = Abs(x);
+  const Pack z = x * x;
+  const Pack p = (-9.64399179425052238628E-1 * z - 9.92877231001918586564E1) * z - 1.61468768441708447952E3;
+  const Pack q = ((z + 1.12811678491632931402E2) * z + 2.23548839060100448583E3) * z + 4.84406305325125486048E3;
+  const Pack small = x + x * z * (p / q);
+  const Pack large = CopySign(1.0 - 2.0 / (Exp(a + a) + 1.0), x);
+  return a < 0.625 ? small : large;
+}
+
+inline Pack Logistic(const Pack x)
+{
+  return 1.0 / (1.0 + Exp(-x));
+}
+
+/* Largest argument for which the Cody-Waite reduction of sine and cosine is accurate */
+static const Scalar TrigonometricLimit = 1.0e8;
+
+/* Reduce |x| to [-pi/4, pi/4]; returns the reduced argument and the octant */
+inline Pack ReduceTrigonometric(const Pack a, IntPack & octant)
+{
+  const Pack magic = Broadcast(6755399441055744.0);
+  const Pack v = a * 1.27323954473516268615;
+  // floor(v) for v >= 0
+  Pack t = v + magic;
+  Pack y = t - magic;
+  IntPack j = (IntPack)t - (IntPack)magic;
+  const IntPack above = y > v;
+  y = above ? y - 1.0 : y;
+  j = j + above;
+  // Map zeros to origin
+  const IntPack odd = (j & 1) != 0;
+  j = j - odd;
+  y = odd ? y + 1.0 : y;
+  octant = j & 7;
+  return ((a - y * 7.85398125648498535156E-1) - y * 3.77489470793079817668E-8) - y * 2.69515142907905952645E-15;
+}
+
+inline Pack SinPolynomial(const Pack z, const Pack zz)
+{
+  return z + z * zz * (((((1.58962301576546568060E-10 * zz - 2.50507477628578072866E-8) * zz + 2.75573136213857245213E-6) * zz - 1.98412698295895385996E-4) * zz + 8.33333333332211858878E-3) * zz - 1.66666666666666307295E-1);
+}
+
+inline Pack CosPolynomial(const Pack zz)
+{
+  return 1.0 - 0.5 * zz + zz * zz * (((((-1.13585365213876817300E-11 * zz + 2.08757008419747316778E-9) * zz - 2.75573141792967388112E-7) * zz + 2.48015872888517045348E-5) * zz - 1.38888888888730564116E-3) * zz + 4.16666666666665929218E-2);
+}
+
+inline Pack Sin(const Pack x)
+{
+  IntPack octant;
+  const Pack z = ReduceTrigonometric(Abs(x), octant);
+  const Pack zz = z * z;
+  const IntPack negate = octant > 3;
+  octant = negate ? octant - 4 : octant;
+  const IntPack useCos = (octant == 1) | (octant == 2);
+  Pack result = useCos ? CosPolynomial(zz) : SinPolynomial(z, zz);
+  result = negate ? -result : result;
+  return x < 0.0 ? -result : result;
+}
+
+inline Pack Cos(const Pack x)
+{
+  IntPack octant;
+  const Pack z = ReduceTrigonometric(Abs(x), octant);
+  const Pack zz = z * z;
+  IntPack negate = octant > 3;
+  octant = negate ? octant - 4 : octant;
+  negate = negate ^ (octant > 1);
+  const IntPack useSin = (octant == 1) | (octant == 2);
+  const Pack result = useSin ? SinPolynomial(z, zz) : CosPolynomial(zz);
+  return negate ? -result : result;
+}
+
+/* 0.5 * atan(x) / atan(1), ie 2 * atan(x) / pi */
+inline Pack Arctan(const Pack x)
+{
+  const Pack a = Abs(x);
+  // Reduce to |x| <= 0.66
+  const IntPack large = a > 2.41421356237309504880;
+  const IntPack medium = (a > 0.66) & ~large;
+  Pack y = large ? Broadcast(1.57079632679489661923) : (medium ? Broadcast(0.78539816339744830962) : Broadcast(0.0));
+  const Pack r = large ? -1.0 / a : (medium ? (a - 1.0) / (a + 1.0) : a);
+  const Pack z = r * r;
+  const Pack p = (((-8.750608600031904122785E-1 * z - 1.615753718733365076637E1) * z - 7.500855792314704667340E1) * z - 1.228866684490136173410E2) * z - 6.485021904942025371773E1;
+  const Pack q = ((((z + 2.485846490142306297962E1) * z + 1.650270098316988542046E2) * z + 4.328810604912902668951E2) * z + 4.853903996359136964868E2) * z + 1.945506571482613964425E2;
+  Pack w = r * (z * p / q) + r;
+  w = large ? w + 6.123233995736765886130E-17 : (medium ? w + 0.5 * 6.123233995736765886130E-17 : w);
+  y = y + w;
+  return CopySign(y, x) * 0.63661977236758134308;
+}
+
+/* Apply a kernel on an array; the tail is padded with zeros */
+template <class KERNEL>
+inline void Apply(Scalar * values, const UnsignedInteger size)
+{
+  UnsignedInteger i = 0;
+  for (; i + Width <= size; i += Width)
+    Store(values + i, KERNEL::Evaluate(Load(values + i)));
+  if (i < size)
+  {
+    Scalar buffer[Width] = {0.0};
+    std::copy(values + i, values + size, buffer);
+    Store(buffer, KERNEL::Evaluate(Load(buffer)));
+    std::copy(buffer, buffer + (size - i), values + i);
+  }
+}
+
+/* Large arguments of sine and cosine are recomputed with the scalar functions */
+template <class KERNEL>
+inline void ApplyTrigonometric(Scalar * values, const UnsignedInteger size)
+{
+  for (UnsignedInteger i = 0; i < size; i += Width)
+  {
+    const UnsignedInteger length = std::min(Width, size - i);
+    Scalar buffer[Width] = {0.0};
+    std::copy(values + i, values + i + length, buffer);
+    const Pack x = Load(buffer);
+    Store(buffer, KERNEL::Evaluate(x));
+    for (UnsignedInteger l = 0; l < length; ++l)
+      values[i + l] = std::abs(x[l]) <= TrigonometricLimit ? buffer[l] : KERNEL::EvaluateScalar(x[l]);
+  }
+}
+
+struct TanhKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return Tanh(x);
+  }
+};
+
+struct LogisticKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return Logistic(x);
+  }
+};
+
+struct ExponentialKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return Exp(x);
+  }
+};
+
+struct ReciprocalKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return 1.0 / x;
+  }
+};
+
+struct SquareKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return x * x;
+  }
+};
+
+struct GaussKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return Exp(-x * x);
+  }
+};
+
+struct SineKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return Sin(x);
+  }
+  static Scalar EvaluateScalar(const Scalar x)
+  {
+    return std::sin(x);
+  }
+};
+
+struct CosineKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return Cos(x);
+  }
+  static Scalar EvaluateScalar(const Scalar x)
+  {
+    return std::cos(x);
+  }
+};
+
+struct ElliottKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return x / (1.0 + Abs(x));
+  }
+};
+
+struct ArctanKernel
+{
+  static Pack Evaluate(const Pack x)
+  {
+    return Arctan(x);
+  }
+};
+
+void Evaluate(const UnsignedInteger type, Scalar * values, const UnsignedInteger size)
+{
+  switch (type)
+  {
+    case Activation::TANH:
+      Apply<TanhKernel>(values, size);
+      break;
+    case Activation::LOGISTIC:
+      Apply<LogisticKernel>(values, size);
+      break;
+    case Activation::EXPONENTIAL:
+      Apply<ExponentialKernel>(values, size);
+      break;
+    case Activation::RECIPROCAL:
+      Apply<ReciprocalKernel>(values, size);
+      break;
+    case Activation::SQUARE:
+      Apply<SquareKernel>(values, size);
+      break;
+    case Activation::GAUSS:
+      Apply<GaussKernel>(values, size);
+      break;
+    case Activation::SINE:
+      ApplyTrigonometric<SineKernel>(values, size);
+      break;
+    case Activation::COSINE:
+      ApplyTrigonometric<CosineKernel>(values, size);
+      break;
+    case Activation::ELLIOTT:
+      Apply<ElliottKernel>(values, size);
+      break;
+    case Activation::ARCTAN:
+      Apply<ArctanKernel>(values, size);
+      break;
+    default:
+      break;
+  }
+}
+
+} /* namespace OTPMML_KERNELS_NAMESPACE */
@@ -0,0 +1,252 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  BinaryDAT.cxx
+ *  @brief Utility class to import/export binary columnar DAT files
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/BinaryDAT.hxx"
+#include "otpmml/DAT.hxx"
+#include "MappedFile.hxx"
+
+#include <openturns/Exception.hxx>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <cerrno>
+#include <cstring> // strerror, memcpy
+#include <stdint.h>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(BinaryDAT)
+
+/* Layout of the files, integers being 64-bit unsigned integers:
+     "OTDATCOL" magic string
+     1          version of the format
+     byte order mark 0x0102030405060708, which tells the byte order of the file
+     number of rows, input dimension, output dimension
+     for each column, the length of its name followed by the name
+   Columns start at the next multiple of BinaryDATAlignment bytes; column j holds the
+   values of all the rows and starts after j columns */
+static const char BinaryDATMagic[8] = {'O', 'T', 'D', 'A', 'T', 'C', 'O', 'L'};
+static const uint64_t BinaryDATVersion = 1;
+static const uint64_t BinaryDATByteOrderMark = 0x0102030405060708ULL;
+static const UnsignedInteger BinaryDATAlignment = 64;
+
+/* Number of values copied at once when a column is written */
+static const UnsignedInteger BinaryDATBlockSize = 1 << 16;
+
+/* Header of a mapped file */
+struct BinaryDATLayout
+{
+  UnsignedInteger size_;
+  UnsignedInteger inputDimension_;
+  UnsignedInteger outputDimension_;
+  Description names_;
+  // Beginning of the first column
+  const char * data_;
+};
+
+/* Read an integer of the header at current, which is moved after it */
+static Bool ReadInteger(const char * & current, const char * last, uint64_t & value)
+{
+  if (static_cast<UnsignedInteger>(last - current) < sizeof(value)) return false;
+  std::memcpy(&value, current, sizeof(value));
+  current += sizeof(value);
+  return true;
+}
+
+static BinaryDATLayout ReadLayout(const MappedFile & file, const FileName & binaryFile)
+{
+  if (file.error_ != 0)
+    throw FileNotFoundException(HERE) << "Could not open file " << binaryFile << " for reading, reason: " << std::strerror(file.error_);
+  const char * current = file.data_;
+  const char * last = file.data_ + file.size_;
+  if ((file.size_ < sizeof(BinaryDATMagic)) || (std::memcmp(current, BinaryDATMagic, sizeof(BinaryDATMagic)) != 0))
+    throw InvalidArgumentException(HERE) << "Error: file " << binaryFile << " is not a binary DAT file";
+  current += sizeof(BinaryDATMagic);
+  uint64_t version = 0;
+  uint64_t byteOrderMark = 0;
+  uint64_t size = 0;
+  uint64_t inputDimension = 0;
+  uint64_t outputDimension = 0;
+  if (!ReadInteger(current, last, version) || !ReadInteger(current, last, byteOrderMark))
+    throw InvalidArgumentException(HERE) << "Error: file " << binaryFile << " is truncated";
+  if (version != BinaryDATVersion)
+    throw InvalidArgumentException(HERE) << "Error: file " << binaryFile << " has version " << version << ", only version " << BinaryDATVersion << " can be read";
+  if (byteOrderMark != BinaryDATByteOrderMark)
+    throw InvalidArgumentException(HERE) << "Error: file " << binaryFile << " has been written by a machine with another byte order";
+  if (!ReadInteger(current, last, size) || !ReadInteger(current, last, inputDimension) || !ReadInteger(current, last, outputDimension))
+    throw InvalidArgumentException(HERE) << "Error: file " << binaryFile << " is truncated";
+  BinaryDATLayout layout;
+  layout.size_ = size;
+  layout.inputDimension_ = inputDimension;
+  layout.outputDimension_ = outputDimension;
+  const UnsignedInteger dimension = layout.inputDimension_ + layout.outputDimension_;
+  for (UnsignedInteger j = 0; j < dimension; ++j)
+  {
+    uint64_t length = 0;
+    if (!ReadInteger(current, last, length) || (static_cast<uint64_t>(last - current) < length))
+      throw InvalidArgumentException(HERE) << "Error: file " << binaryFile << " is truncated";
+    layout.names_.add(String(current, current + length));
+    current += length;
+  }
+  const UnsignedInteger offset = current - file.data_;
+  const UnsignedInteger dataOffset = (offset + BinaryDATAlignment - 1) / BinaryDATAlignment * BinaryDATAlignment;
+  if ((dimension > 0) && (layout.size_ > (file.size_ - std::min<UnsignedInteger>(dataOffset, file.size_)) / sizeof(Scalar) / dimension))
+    throw InvalidArgumentException(HERE) << "Error: file " << binaryFile << " is truncated";
+  layout.data_ = file.data_ + dataOffset;
+  return layout;
+}
+
+/* Copy the given columns of the mapping into a sample */
+static Sample ReadColumns(const BinaryDATLayout & layout, const Indices & columns)
+{
+  const UnsignedInteger dimension = columns.getSize();
+  Sample sample(layout.size_, dimension);
+  Description description(dimension);
+  for (UnsignedInteger k = 0; k < dimension; ++k)
+    description[k] = layout.names_[columns[k]];
+  sample.setDescription(description);
+  if (layout.size_ == 0 || dimension == 0) return sample;
+  Scalar * data = &sample(0, 0);
+  for (UnsignedInteger k = 0; k < dimension; ++k)
+  {
+    // Columns are read one after the other, which only touches their own pages
+    const char * column = layout.data_ + columns[k] * layout.size_ * sizeof(Scalar);
+    for (UnsignedInteger i = 0; i < layout.size_; ++i)
+      std::memcpy(data + i * dimension + k, column + i * sizeof(Scalar), sizeof(Scalar));
+  }
+  return sample;
+}
+
+/** Import experiment plane from a binary file */
+BinaryDAT::SampleCollection BinaryDAT::Import(const FileName & binaryFile)
+{
+  const MappedFile file(binaryFile);
+  const BinaryDATLayout layout(ReadLayout(file, binaryFile));
+  Indices inputColumns(layout.inputDimension_);
+  inputColumns.fill();
+  Indices outputColumns(layout.outputDimension_);
+  outputColumns.fill(layout.inputDimension_);
+  SampleCollection result(2);
+  result[0] = ReadColumns(layout, inputColumns);
+  result[1] = ReadColumns(layout, outputColumns);
+  return result;
+}
+
+/** Import the given columns of a binary file */
+Sample BinaryDAT::Import(const FileName & binaryFile, const Indices & columns)
+{
+  const MappedFile file(binaryFile);
+  const BinaryDATLayout layout(ReadLayout(file, binaryFile));
+  const UnsignedInteger dimension = layout.inputDimension_ + layout.outputDimension_;
+  for (UnsignedInteger k = 0; k < columns.getSize(); ++k)
+    if (columns[k] >= dimension)
+      throw InvalidArgumentException(HERE) << "Error: column index " << columns[k] << " must be less than " << dimension;
+  return ReadColumns(layout, columns);
+}
+
+/** Names of the columns of a binary file */
+Description BinaryDAT::GetColumnNames(const FileName & binaryFile)
+{
+  const MappedFile file(binaryFile);
+  return ReadLayout(file, binaryFile).names_;
+}
+
+/* Write an integer of the header */
+static void WriteInteger(std::ofstream & outFile, const uint64_t value)
+{
+  outFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/** Export experiment plane into a binary file */
+void BinaryDAT::Export(const FileName & binaryFile, const Sample & input, const Sample & output)
+{
+  if (output.getSize() != input.getSize())
+    throw InvalidArgumentException(HERE) << "Size mismatch: input size != output size";
+  const UnsignedInteger size = input.getSize();
+  const UnsignedInteger inputDimension = input.getDimension();
+  const UnsignedInteger outputDimension = output.getDimension();
+  Description names(input.getDescription());
+  if (names.getSize() != inputDimension)
+    names = Description::BuildDefault(inputDimension, "x");
+  const Description outputNames(output.getDescription());
+  names.add(outputNames.getSize() == outputDimension ? outputNames : Description::BuildDefault(outputDimension, "y"));
+
+  std::ofstream outFile(binaryFile.c_str(), std::ios::out | std::ios::binary);
+  if (outFile.fail())
+    throw FileOpenException(HERE) << "Could not open file " << binaryFile << " for writing, reason: " << std::strerror(errno);
+
+  outFile.write(BinaryDATMagic, sizeof(BinaryDATMagic));
+  WriteInteger(outFile, BinaryDATVersion);
+  WriteInteger(outFile, BinaryDATByteOrderMark);
+  WriteInteger(outFile, size);
+  WriteInteger(outFile, inputDimension);
+  WriteInteger(outFile, outputDimension);
+  UnsignedInteger offset = sizeof(BinaryDATMagic) + 5 * sizeof(uint64_t);
+  for (UnsignedInteger j = 0; j < names.getSize(); ++j)
+  {
+    WriteInteger(outFile, names[j].size());
+    outFile.write(names[j].data(), names[j].size());
+    offset += sizeof(uint64_t) + names[j].size();
+  }
+  const std::vector<char> padding((BinaryDATAlignment - offset % BinaryDATAlignment) % BinaryDATAlignment, '\0');
+  if (!padding.empty())
+    outFile.write(&padding[0], padding.size());
+
+  // Rows are transposed by blocks
+  std::vector<Scalar> block(std::min(size, BinaryDATBlockSize));
+  for (UnsignedInteger j = 0; j < inputDimension + outputDimension; ++j)
+  {
+    const Sample & sample = (j < inputDimension) ? input : output;
+    const UnsignedInteger column = (j < inputDimension) ? j : j - inputDimension;
+    for (UnsignedInteger first = 0; first < size; first += block.size())
+    {
+      const UnsignedInteger last = std::min(size, first + block.size());
+      for (UnsignedInteger i = first; i < last; ++i)
+        block[i - first] = sample(i, column);
+      outFile.write(reinterpret_cast<const char *>(&block[0]), (last - first) * sizeof(Scalar));
+    }
+  }
+
+  outFile.close();
+  if (outFile.fail())
+    throw FileOpenException(HERE) << "Could not write file " << binaryFile << ", reason: " << std::strerror(errno);
+}
+
+/** Convert a .dat file into a binary file */
+void BinaryDAT::ConvertFromDAT(const FileName & datFile, const FileName & binaryFile)
+{
+  const SampleCollection samples(DAT::Import(datFile));
+  Export(binaryFile, samples[0], samples[1]);
+}
+
+/** Convert a binary file into a .dat file */
+void BinaryDAT::ConvertToDAT(const FileName & binaryFile, const FileName & datFile)
+{
+  const SampleCollection samples(Import(binaryFile));
+  DAT::Export(datFile, samples[0], samples[1]);
+}
+
+} /* namespace OTPMML */
@@ -23,6 +23,9 @@
 #include "otpmml/DAT.hxx"
 #include "otpmml/PMMLDoc.hxx"
 #include "otpmml/PMMLNeuralNetwork.hxx"
+#include "DATParsing.hxx"
+#include "MappedFile.hxx"
+#include "ParallelTasks.hxx"
 
 #include <openturns/Log.hxx>
 #include <openturns/Exception.hxx>
@@ -31,9 +34,13 @@
 
 #include <libxml/parser.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <vector>
 #include <cstdio>  // errno
-#include <cstring> // strerror
+#include <cstring> // strerror, memchr
 
 using namespace OT;
 
@@ -42,118 +49,212 @@ namespace OTPMML
 
 CLASSNAMEINIT(DAT)
 
+/* Files are split into chunks of at least this size, smaller files are parsed by the calling thread */
+static const UnsignedInteger DATMinimumChunkSize = 1 << 20;
+
+/* Number of rows formatted at once by a thread when a file is exported */
+static const UnsignedInteger DATExportBlockSize = 4096;
+
 /** Import experiment plane from a .dat file */
-DAT::SampleCollection DAT::Import(const FileName& datFile)
+DAT::SampleCollection DAT::Import(const FileName& datFile, const UnsignedInteger numberOfThreads)
 {
-  // Read file contents into a single Sample
-  Sample inputOutput(Sample::ImportFromTextFile(datFile));
-
-  // Re-read file to parse comments and set NS description
-  std::ifstream inputFile(datFile.c_str());
-  if (!inputFile.is_open())
-    throw FileNotFoundException(HERE) << "Could not open file " << datFile << " for reading, reason: " << std::strerror(errno);
-  String line;
-  while (!inputFile.eof())
+  // The file is mapped, its layout is found first so that values are parsed
+  // directly into the input and output samples
+  const MappedFile file(datFile);
+  if (file.error_ != 0)
+    throw FileNotFoundException(HERE) << "Could not open file " << datFile << " for reading, reason: " << std::strerror(file.error_);
+  const char * last = file.data_ + file.size_;
+  String header;
+  Bool headerFound = false;
+  UnsignedInteger dimension = 0;
+  UnsignedInteger lineNumber = 0;
+  const char * first = FindFirstRow(file.data_, last, header, headerFound, dimension, lineNumber);
+  if (first == last)
+    throw InvalidArgumentException(HERE) << "No data found in file " << datFile;
+  if (!headerFound)
+    LOGWARN(OSS() << "Unable to find column description in file " << datFile);
+
+  // The rows are split into chunks which end at a newline, a few chunks per thread
+  // so that threads which are done early pick the remaining ones
+  const UnsignedInteger threadsNumber = GetNumberOfThreads(numberOfThreads);
+  const UnsignedInteger length = last - first;
+  const UnsignedInteger numberOfChunks = std::max<UnsignedInteger>(1, std::min<UnsignedInteger>(4 * threadsNumber, length / DATMinimumChunkSize));
+  std::vector<const char *> bounds(numberOfChunks + 1, last);
+  bounds[0] = first;
+  for (UnsignedInteger i = 1; i < numberOfChunks; ++i)
   {
-    std::getline(inputFile, line);
-    if (inputFile.eof() || line.empty() || line[0] != '#')
-    {
-      LOGWARN(OSS() << "Unable to find column description in file " << datFile);
-      line = "";
-      break;
-    }
-    if (line.substr(0, 14) == "#COLUMN_NAMES:")
-    {
-      line = line.substr(14);
-      break;
-    }
+    const char * middle = std::max(first + i * (length / numberOfChunks), bounds[i - 1]);
+    const char * end = static_cast<const char *>(std::memchr(middle, '\n', last - middle));
+    bounds[i] = (end == NULL) ? last : end + 1;
   }
-  inputFile.close();
-  Description fileDescription;
-  if (!line.empty())
+
+  // Rows are counted first, which gives where each chunk is stored and the line number
+  // of its first line; then chunks are parsed directly into the samples
+  std::vector<UnsignedInteger> rows(numberOfChunks);
+  std::vector<UnsignedInteger> lines(numberOfChunks);
+  RunTasks(numberOfChunks, threadsNumber, [&](const UnsignedInteger i)
   {
-    // Now extract column description
-    // We do not care about trailing spaces, they will be taken care of automatically
-    std::size_t pos;
-    while ((pos = line.find("|")) != std::string::npos)
-    {
-      String desc(line.substr(0, pos));
-      line = line.substr(pos + 1);
-      // Trim whitespace
-      while (!desc.empty() && (desc[0] == ' ' || desc[0] == '\t'))
-        desc = desc.substr(1);
-      fileDescription.add(desc);
-    }
-    // Trim whitespace
-    while (!line.empty() && (line[0] == ' ' || line[0] == '\t'))
-      line = line.substr(1);
-    fileDescription.add(line);
-    inputOutput.setDescription(fileDescription);
+    CountRows(bounds[i], bounds[i + 1], rows[i], lines[i]);
+  });
+  std::vector<UnsignedInteger> rowOffsets(numberOfChunks);
+  std::vector<UnsignedInteger> lineNumbers(numberOfChunks);
+  UnsignedInteger size = 0;
+  for (UnsignedInteger i = 0; i < numberOfChunks; ++i)
+  {
+    rowOffsets[i] = size;
+    lineNumbers[i] = lineNumber;
+    size += rows[i];
+    lineNumber += lines[i];
   }
 
-  // Now split into 2 Sample for input and output.
-  // There is no "unstack" method, do it by hand.
-  const UnsignedInteger size(inputOutput.getSize());
-  const UnsignedInteger dimension(inputOutput.getDimension());
   Sample x(size, dimension - 1);
-  for (UnsignedInteger i = 0; i < size; ++i)
-    for (UnsignedInteger j = 0; j + 1 < dimension; ++j)
-      x[i][j] = inputOutput[i][j];
-  if (!fileDescription.isEmpty())
+  Sample y(size, 1);
+  Scalar * input = (dimension > 1) ? &x(0, 0) : NULL;
+  Scalar * output = &y(0, 0);
+  RunTasks(numberOfChunks, threadsNumber, [&](const UnsignedInteger i)
   {
+    ParseRows(bounds[i], bounds[i + 1], lineNumbers[i], dimension, dimension - 1,
+              input + rowOffsets[i] * (dimension - 1), output + rowOffsets[i], datFile);
+  });
+
+  if (!header.empty())
+  {
+    Description fileDescription(ParseColumnNames(header, dimension, datFile));
+    y.setDescription(Description(1, fileDescription[dimension - 1]));
     fileDescription.erase(fileDescription.begin() + dimension - 1);
     x.setDescription(fileDescription);
   }
   Collection<Sample> result(2);
   result[0] = x;
-  result[1] = inputOutput.getMarginal(dimension - 1);
+  result[1] = y;
   return result;
 }
 
-/** Export experiment plane into a .dat file.
-    Sample contains both input and output */
-void DAT::Export(const FileName& datFile, const Sample& inputOutput)
+/* Write the rows made of the values of input followed by the values of output.
+   Blocks of rows are formatted by several threads, and each block is written at once,
+   in the order of the rows, while the next blocks are being formatted */
+static void ExportRows(const FileName & datFile, const Description & description,
+                       const Sample & input, const Sample & output, const UnsignedInteger numberOfThreads)
 {
-  const UnsignedInteger size(inputOutput.getSize());
-  const Description description(inputOutput.getDescription());
-  const UnsignedInteger dimension(inputOutput.getDimension());
+  const UnsignedInteger size = input.getSize();
+  const UnsignedInteger inputDimension = input.getDimension();
+  const UnsignedInteger outputDimension = output.getDimension();
+  const UnsignedInteger dimension = inputDimension + outputDimension;
 
-  std::ofstream outFile(datFile.c_str());
+  std::ofstream outFile(datFile.c_str(), std::ios::out | std::ios::binary);
   if (outFile.fail())
     throw FileOpenException(HERE) << "Could not open file " << datFile << " for writing, reason: " << std::strerror(errno);
 
-  outFile.imbue(std::locale("C"));
-  outFile.precision(16);
   // Export the description
-  outFile << "#COLUMN_NAMES: ";
+  const String endOfLine(Os::GetEndOfLine());
+  String header("#COLUMN_NAMES: ");
   for (UnsignedInteger i = 0; i < dimension; ++i)
   {
-    if (i != 0) outFile << "| ";
-    outFile << description[i];
+    if (i != 0) header += "| ";
+    header += description[i];
   }
-  outFile << Os::GetEndOfLine() << Os::GetEndOfLine();
+  header += endOfLine + endOfLine;
+  outFile.write(header.data(), header.size());
 
   // Write the data
-  for(UnsignedInteger i = 0; i < size; ++i)
+  const Scalar * inputData = (size > 0 && inputDimension > 0) ? &input(0, 0) : NULL;
+  const Scalar * outputData = (size > 0 && outputDimension > 0) ? &output(0, 0) : NULL;
+  const UnsignedInteger threadsNumber = GetNumberOfThreads(numberOfThreads);
+  const UnsignedInteger blocksNumber = (size + DATExportBlockSize - 1) / DATExportBlockSize;
+  // Blocks are formatted in two sets of 4 buffers per thread, so that the
+  // blocks written to the file do not stop the formatting of the next ones
+  const UnsignedInteger slotsNumber = std::min<UnsignedInteger>(blocksNumber, 8 * threadsNumber);
+  std::vector<std::vector<char> > buffers(slotsNumber);
+  std::vector<UnsignedInteger> lengths(slotsNumber);
+  // Shared state: blocks are written in order by the thread which formats
+  // the next block to write, or by the one already writing
+  std::mutex mutex;
+  std::condition_variable slotFreed;
+  std::vector<char> formatted(slotsNumber, false);
+  UnsignedInteger writtenBlocks = 0;
+  Bool writing = false;
+  Bool aborted = false;
+  RunTasks(blocksNumber, threadsNumber, [&](const UnsignedInteger block)
   {
-    String separator;
-    for(UnsignedInteger j = 0; j < dimension; ++j, separator = " ")
-      outFile << separator << std::scientific << inputOutput(i, j);
-    outFile << Os::GetEndOfLine();
-  }
+    const UnsignedInteger slot = block % slotsNumber;
+    {
+      // Wait until the block previously formatted in this slot is written
+      std::unique_lock<std::mutex> lock(mutex);
+      slotFreed.wait(lock, [&]() { return aborted || block < writtenBlocks + slotsNumber; });
+      if (aborted) return;
+    }
+    try
+    {
+      const UnsignedInteger firstRow = block * DATExportBlockSize;
+      const UnsignedInteger lastRow = std::min(size, firstRow + DATExportBlockSize);
+      std::vector<char> & buffer = buffers[slot];
+      buffer.resize((lastRow - firstRow) * (dimension * ScalarTextSize + endOfLine.size()));
+      char * current = &buffer[0];
+      for (UnsignedInteger row = firstRow; row < lastRow; ++row)
+      {
+        for (UnsignedInteger j = 0; j < inputDimension; ++j)
+        {
+          if (j != 0) *current++ = ' ';
+          current = FormatScalar(current, inputData[row * inputDimension + j]);
+        }
+        for (UnsignedInteger j = 0; j < outputDimension; ++j)
+        {
+          if (inputDimension + j != 0) *current++ = ' ';
+          current = FormatScalar(current, outputData[row * outputDimension + j]);
+        }
+        current = std::copy(endOfLine.begin(), endOfLine.end(), current);
+      }
+      lengths[slot] = current - &buffer[0];
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      aborted = true;
+      slotFreed.notify_all();
+      throw;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    formatted[slot] = true;
+    if (writing) return;
+    writing = true;
+    while (!aborted && writtenBlocks < blocksNumber && formatted[writtenBlocks % slotsNumber])
+    {
+      const UnsignedInteger writtenSlot = writtenBlocks % slotsNumber;
+      // The other threads keep formatting while the block is written
+      lock.unlock();
+      outFile.write(&buffers[writtenSlot][0], lengths[writtenSlot]);
+      lock.lock();
+      formatted[writtenSlot] = false;
+      ++writtenBlocks;
+      // The error is reported when the file is closed
+      if (outFile.fail()) aborted = true;
+      slotFreed.notify_all();
+    }
+    writing = false;
+  });
 
   // Close the file
   outFile.close();
+  if (outFile.fail())
+    throw FileOpenException(HERE) << "Could not write file " << datFile << ", reason: " << std::strerror(errno);
+}
+
+/** Export experiment plane into a .dat file.
+    Sample contains both input and output */
+void DAT::Export(const FileName& datFile, const Sample& inputOutput, const UnsignedInteger numberOfThreads)
+{
+  ExportRows(datFile, inputOutput.getDescription(), inputOutput, Sample(inputOutput.getSize(), 0), numberOfThreads);
 }
 
 /** Export experiment plane into a .dat file */
-void DAT::Export(const FileName& datFile, const Sample& input, const Sample& output)
+void DAT::Export(const FileName& datFile, const Sample& input, const Sample& output, const UnsignedInteger numberOfThreads)
 {
   if (output.getSize() != input.getSize())
     throw InvalidArgumentException(HERE) << "Size mismatch: input size != output size";
-  Sample inputOutput(input);
-  inputOutput.stack(output);
-  Export(datFile, inputOutput);
+  // Values are read from both samples, which are not stacked
+  Description description(input.getDescription());
+  description.add(output.getDescription());
+  ExportRows(datFile, description, input, output, numberOfThreads);
 }
 
 } /* namespace OTPMML */
@@ -0,0 +1,193 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  DATParsing.hxx
+ *  @brief Reading of the lines of .dat files
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+// This file is not a regular header: it is only included by the sources which
+// read .dat files, it is not installed.
+
+#ifndef OTPMML_DATPARSING_HXX
+#define OTPMML_DATPARSING_HXX
+
+#include <openturns/OTprivate.hxx>
+#include <openturns/Exception.hxx>
+#include <openturns/Description.hxx>
+
+#include <cstring>
+#include <limits>
+
+#include "NumberParsing.hxx"
+
+namespace OTPMML
+{
+
+/* Lines of a .dat file: comments start with '#', and the description of the columns
+   is the "#COLUMN_NAMES:" comment before the data; the other lines hold numbers separated
+   by blanks, in the C syntax whatever the locale is, and lines with only blanks are ignored */
+
+/* End of the line which starts at first, without its end of line; next is set to the beginning of the following line */
+inline const char * FindEndOfLine(const char * first, const char * last, const char * & next)
+{
+  const char * end = static_cast<const char *>(std::memchr(first, '\n', last - first));
+  if (end == NULL)
+    end = last;
+  next = (end == last) ? last : end + 1;
+  if (end != first && end[-1] == '\r') --end;
+  return end;
+}
+
+inline OT::Bool IsBlankLine(const char * first, const char * last)
+{
+  while (first != last && IsNumberBlank(*first)) ++first;
+  return first == last;
+}
+
+inline OT::UnsignedInteger CountTokens(const char * first, const char * last)
+{
+  OT::UnsignedInteger count = 0;
+  while (true)
+  {
+    while (first != last && IsNumberBlank(*first)) ++first;
+    if (first == last) return count;
+    ++count;
+    while (first != last && !IsNumberBlank(*first)) ++first;
+  }
+}
+
+/* Find the description and the number of columns, which is given by the first row.
+   Return the beginning of the line of the first row, or last if there is no row;
+   lineNumber is set to its line number */
+inline const char * FindFirstRow(const char * first, const char * last, OT::String & header, OT::Bool & headerFound,
+                                 OT::UnsignedInteger & dimension, OT::UnsignedInteger & lineNumber)
+{
+  headerFound = false;
+  dimension = 0;
+  lineNumber = 1;
+  const char * next = first;
+  for (const char * line = first; line != last; line = next, ++lineNumber)
+  {
+    const char * end = FindEndOfLine(line, last, next);
+    if (line == end) continue;
+    if (*line == '#')
+    {
+      if (!headerFound && (end - line >= 14) && (std::memcmp(line, "#COLUMN_NAMES:", 14) == 0))
+      {
+        header = OT::String(line + 14, end);
+        headerFound = true;
+      }
+      continue;
+    }
+    dimension = CountTokens(line, end);
+    if (dimension > 0) return line;
+  }
+  return last;
+}
+
+/* Count the rows and the lines of [first, last), without parsing numbers; counting stops
+   after maxRows rows. Return the end of the last line which has been counted */
+inline const char * CountRows(const char * first, const char * last, OT::UnsignedInteger & rows, OT::UnsignedInteger & lines,
+                              const OT::UnsignedInteger maxRows = std::numeric_limits<OT::UnsignedInteger>::max())
+{
+  rows = 0;
+  lines = 0;
+  const char * next = first;
+  const char * line = first;
+  for (; line != last && rows < maxRows; line = next, ++lines)
+  {
+    const char * end = FindEndOfLine(line, last, next);
+    if (line == end || *line == '#' || IsBlankLine(line, end)) continue;
+    ++rows;
+  }
+  return line;
+}
+
+/* Parse the rows of the lines [first, last), the first one being the line lineNumber of the file;
+   the first inputDimension values of a row are stored into input, the other ones into output.
+   Return the number of rows */
+inline OT::UnsignedInteger ParseRows(const char * first, const char * last, OT::UnsignedInteger lineNumber,
+                                     const OT::UnsignedInteger dimension, const OT::UnsignedInteger inputDimension,
+                                     OT::Scalar * input, OT::Scalar * output, const OT::FileName & datFile)
+{
+  const OT::UnsignedInteger outputDimension = dimension - inputDimension;
+  OT::UnsignedInteger rows = 0;
+  const char * next = first;
+  for (const char * line = first; line != last; line = next, ++lineNumber)
+  {
+    const char * end = FindEndOfLine(line, last, next);
+    if (line == end || *line == '#') continue;
+    OT::Scalar * inputRow = input + rows * inputDimension;
+    OT::Scalar * outputRow = output + rows * outputDimension;
+    OT::UnsignedInteger count = 0;
+    const char * current = line;
+    while (true)
+    {
+      while (current != end && IsNumberBlank(*current)) ++current;
+      if (current == end) break;
+      OT::Scalar value = 0.0;
+      const char * tokenEnd = ParseScalar(current, end, value);
+      if (tokenEnd == NULL || (tokenEnd != end && !IsNumberBlank(*tokenEnd)))
+      {
+        tokenEnd = current;
+        while (tokenEnd != end && !IsNumberBlank(*tokenEnd)) ++tokenEnd;
+        throw OT::InvalidArgumentException(HERE) << "Invalid numerical value '" << OT::String(current, tokenEnd) << "' at line " << lineNumber << " of file " << datFile;
+      }
+      if (count < inputDimension)
+        inputRow[count] = value;
+      else if (count < dimension)
+        outputRow[count - inputDimension] = value;
+      ++count;
+      current = tokenEnd;
+    }
+    if (count == 0) continue;
+    if (count != dimension)
+      throw OT::InvalidArgumentException(HERE) << "Line " << lineNumber << " of file " << datFile << " has " << count << " values, but previous lines have " << dimension;
+    ++rows;
+  }
+  return rows;
+}
+
+/* Names of the columns given by the text after "#COLUMN_NAMES:", separated by '|' */
+inline OT::Description ParseColumnNames(OT::String header, const OT::UnsignedInteger dimension, const OT::FileName & datFile)
+{
+  OT::Description fileDescription;
+  // We do not care about trailing spaces, they will be taken care of automatically
+  std::size_t pos;
+  while ((pos = header.find("|")) != std::string::npos)
+  {
+    OT::String desc(header.substr(0, pos));
+    header = header.substr(pos + 1);
+    // Trim whitespace
+    while (!desc.empty() && (desc[0] == ' ' || desc[0] == '\t'))
+      desc = desc.substr(1);
+    fileDescription.add(desc);
+  }
+  // Trim whitespace
+  while (!header.empty() && (header[0] == ' ' || header[0] == '\t'))
+    header = header.substr(1);
+  fileDescription.add(header);
+  if (fileDescription.getSize() != dimension)
+    throw OT::InvalidArgumentException(HERE) << "The column description of file " << datFile << " has " << fileDescription.getSize() << " names, but lines have " << dimension << " values";
+  return fileDescription;
+}
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_DATPARSING_HXX */
@@ -0,0 +1,346 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  DATReader.cxx
+ *  @brief Reads a .dat file by batches of rows
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/DATReader.hxx"
+#include "DATParsing.hxx"
+
+#include <openturns/Log.hxx>
+#include <openturns/Exception.hxx>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring> // strerror
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(DATReader)
+
+/* Number of batches parsed ahead of the caller */
+static const UnsignedInteger DATReaderQueueSize = 2;
+
+/* Size of the blocks read from the file; the buffer grows if a line is longer */
+static const UnsignedInteger DATReaderBlockSize = 1 << 20;
+
+/* The file is read by blocks into buffer_, and only complete lines are parsed.
+   Once the thread is started, the file and the buffer are only used by it,
+   the queue of batches is protected by mutex_ */
+class DATReader::State
+{
+public:
+  State(const FileName & datFile, const UnsignedInteger batchSize);
+  ~State();
+
+  /** Wait for the next batch; return false at the end of the file */
+  Bool waitForBatch();
+
+  SampleCollection popBatch();
+
+  const FileName fileName_;
+  const UnsignedInteger batchSize_;
+  UnsignedInteger dimension_;
+  // Descriptions are only set when the file has a non-empty #COLUMN_NAMES: line
+  Bool hasDescription_;
+  Description inputDescription_;
+  Description outputDescription_;
+  UnsignedInteger rowsNumber_;
+
+private:
+  /** Read the next block, after moving the unparsed data to the front of the buffer */
+  void fill();
+
+  /** End of the complete lines of the buffer */
+  const char * getCompleteLinesEnd() const;
+
+  /** Parse up to batchSize_ rows; return false at the end of the file */
+  Bool readBatch(Sample & input, Sample & output);
+
+  /** Body of the thread */
+  void run();
+
+  std::ifstream file_;
+  std::vector<char> buffer_;
+  // Unparsed data is [begin_, end_)
+  UnsignedInteger begin_;
+  UnsignedInteger end_;
+  Bool endOfFile_;
+  UnsignedInteger lineNumber_;
+
+  std::mutex mutex_;
+  std::condition_variable batchAdded_;
+  std::condition_variable batchRemoved_;
+  std::deque<SampleCollection> batches_;
+  std::exception_ptr error_;
+  Bool done_;
+  Bool stop_;
+  std::thread thread_;
+};
+
+DATReader::State::State(const FileName & datFile, const UnsignedInteger batchSize)
+  : fileName_(datFile)
+  , batchSize_(batchSize)
+  , dimension_(0)
+  , hasDescription_(false)
+  , rowsNumber_(0)
+  , file_(datFile.c_str(), std::ios::in | std::ios::binary)
+  , buffer_(DATReaderBlockSize)
+  , begin_(0)
+  , end_(0)
+  , endOfFile_(false)
+  , lineNumber_(1)
+  , done_(false)
+  , stop_(false)
+{
+  if (batchSize == 0)
+    throw InvalidArgumentException(HERE) << "Error: the batch size must be positive";
+  if (file_.fail())
+    throw FileNotFoundException(HERE) << "Could not open file " << datFile << " for reading, reason: " << std::strerror(errno);
+
+  // The lines before the first row are kept in the buffer until it is found
+  String header;
+  Bool headerFound = false;
+  const char * first = NULL;
+  while (true)
+  {
+    fill();
+    const char * last = getCompleteLinesEnd();
+    first = FindFirstRow(&buffer_[0], last, header, headerFound, dimension_, lineNumber_);
+    if (first != last || endOfFile_) break;
+  }
+  if (dimension_ == 0)
+    throw InvalidArgumentException(HERE) << "No data found in file " << datFile;
+  begin_ = first - &buffer_[0];
+  if (!headerFound)
+    LOGWARN(OSS() << "Unable to find column description in file " << datFile);
+  if (!header.empty())
+  {
+    hasDescription_ = true;
+    inputDescription_ = ParseColumnNames(header, dimension_, datFile);
+    outputDescription_ = Description(1, inputDescription_[dimension_ - 1]);
+    inputDescription_.erase(inputDescription_.begin() + dimension_ - 1);
+  }
+
+  thread_ = std::thread(&State::run, this);
+}
+
+DATReader::State::~State()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  batchRemoved_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void DATReader::State::fill()
+{
+  std::copy(buffer_.begin() + begin_, buffer_.begin() + end_, buffer_.begin());
+  end_ -= begin_;
+  begin_ = 0;
+  if (end_ == buffer_.size())
+    buffer_.resize(2 * buffer_.size());
+  file_.read(&buffer_[end_], buffer_.size() - end_);
+  end_ += file_.gcount();
+  if (file_.bad())
+    throw FileOpenException(HERE) << "Could not read file " << fileName_ << ", reason: " << std::strerror(errno);
+  endOfFile_ = file_.eof();
+}
+
+const char * DATReader::State::getCompleteLinesEnd() const
+{
+  // The last line of the file may have no end of line
+  if (endOfFile_)
+    return &buffer_[0] + end_;
+  UnsignedInteger end = end_;
+  while (end > begin_ && buffer_[end - 1] != '\n') --end;
+  return &buffer_[0] + end;
+}
+
+Bool DATReader::State::readBatch(Sample & input, Sample & output)
+{
+  input = Sample(batchSize_, dimension_ - 1);
+  output = Sample(batchSize_, 1);
+  Scalar * inputData = (dimension_ > 1) ? &input(0, 0) : NULL;
+  Scalar * outputData = &output(0, 0);
+  UnsignedInteger size = 0;
+  while (size < batchSize_)
+  {
+    const char * first = &buffer_[0] + begin_;
+    UnsignedInteger rows = 0;
+    UnsignedInteger lines = 0;
+    const char * last = CountRows(first, getCompleteLinesEnd(), rows, lines, batchSize_ - size);
+    ParseRows(first, last, lineNumber_, dimension_, dimension_ - 1, inputData + size * (dimension_ - 1), outputData + size, fileName_);
+    size += rows;
+    lineNumber_ += lines;
+    begin_ = last - &buffer_[0];
+    if (size < batchSize_)
+    {
+      if (endOfFile_ && (begin_ == end_)) break;
+      fill();
+    }
+  }
+  if (size == 0) return false;
+  if (size < batchSize_)
+  {
+    input.erase(size, batchSize_);
+    output.erase(size, batchSize_);
+  }
+  if (hasDescription_)
+  {
+    input.setDescription(inputDescription_);
+    output.setDescription(outputDescription_);
+  }
+  return true;
+}
+
+void DATReader::State::run()
+{
+  try
+  {
+    Sample input;
+    Sample output;
+    while (readBatch(input, output))
+    {
+      SampleCollection batch(2);
+      batch[0] = input;
+      batch[1] = output;
+      std::unique_lock<std::mutex> lock(mutex_);
+      batchRemoved_.wait(lock, [this]() { return stop_ || (batches_.size() < DATReaderQueueSize); });
+      if (stop_) return;
+      batches_.push_back(batch);
+      batchAdded_.notify_one();
+    }
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  done_ = true;
+  batchAdded_.notify_all();
+}
+
+Bool DATReader::State::waitForBatch()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  batchAdded_.wait(lock, [this]() { return done_ || !batches_.empty(); });
+  if (!batches_.empty()) return true;
+  // Batches parsed before an error are returned first
+  if (error_)
+    std::rethrow_exception(error_);
+  return false;
+}
+
+DATReader::SampleCollection DATReader::State::popBatch()
+{
+  if (!waitForBatch())
+    throw InvalidArgumentException(HERE) << "Error: all the rows of file " << fileName_ << " have been read";
+  SampleCollection batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch = batches_.front();
+    batches_.pop_front();
+  }
+  batchRemoved_.notify_one();
+  rowsNumber_ += batch[0].getSize();
+  return batch;
+}
+
+/* Parameters constructor */
+DATReader::DATReader(const FileName & datFile, const UnsignedInteger batchSize)
+  : Object()
+  , p_state_(new State(datFile, batchSize))
+{
+  // Nothing to do
+}
+
+/* Whether another batch can be read */
+Bool DATReader::hasNext() const
+{
+  return p_state_->waitForBatch();
+}
+
+/* Next batch */
+DATReader::SampleCollection DATReader::getNext()
+{
+  return p_state_->popBatch();
+}
+
+/* Number of rows returned so far */
+UnsignedInteger DATReader::getRowsNumber() const
+{
+  return p_state_->rowsNumber_;
+}
+
+/* Descriptions accessors */
+Description DATReader::getInputDescription() const
+{
+  return p_state_->inputDescription_;
+}
+
+Description DATReader::getOutputDescription() const
+{
+  return p_state_->outputDescription_;
+}
+
+/* Number of input columns */
+UnsignedInteger DATReader::getInputDimension() const
+{
+  return p_state_->dimension_ - 1;
+}
+
+/* Batch size accessor */
+UnsignedInteger DATReader::getBatchSize() const
+{
+  return p_state_->batchSize_;
+}
+
+/* File name accessor */
+FileName DATReader::getFileName() const
+{
+  return p_state_->fileName_;
+}
+
+/* String converter */
+String DATReader::__repr__() const
+{
+  return OSS(true) << "class=" << DATReader::GetClassName()
+         << " fileName=" << getFileName()
+         << " batchSize=" << getBatchSize()
+         << " inputDescription=" << getInputDescription()
+         << " outputDescription=" << getOutputDescription()
+         << " rowsNumber=" << getRowsNumber();
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,266 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LazyNeuralNetworkEvaluation.cxx
+ *  @brief Neural network built on its first evaluation
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/LazyNeuralNetworkEvaluation.hxx"
+#include "otpmml/PMMLDoc.hxx"
+#include "otpmml/PMMLNeuralNetwork.hxx"
+
+#include <openturns/PersistentObjectFactory.hxx>
+#include <openturns/Exception.hxx>
+
+#include <atomic>
+#include <mutex>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(LazyNeuralNetworkEvaluation)
+
+static const Factory<LazyNeuralNetworkEvaluation> Factory_LazyNeuralNetworkEvaluation;
+
+/* Where the network is read from, and the network once it is built */
+struct LazyNeuralNetworkEvaluation::State
+{
+  State()
+    : mode_(NeuralNetwork::NATIVE)
+    , loaded_(false)
+  {
+  }
+
+  /** PMML file, read again when the network is built */
+  FileName fileName_;
+
+  /** Document held in memory, null if it is read from fileName_ */
+  Pointer<PMMLBuffer> p_buffer_;
+
+  /** Arguments of the NeuralNetwork constructor */
+  String modelName_;
+  NeuralNetwork::EvaluationMode mode_;
+  FileName cacheFile_;
+
+  /** The network is built once, even when it is first evaluated by several threads */
+  std::once_flag once_;
+  std::atomic<bool> loaded_;
+  Function function_;
+};
+
+/* Default constructor */
+LazyNeuralNetworkEvaluation::LazyNeuralNetworkEvaluation()
+  : EvaluationImplementation()
+  , p_state_(new State)
+  , layerSizes_(1, 0)
+{
+  // Nothing to do
+}
+
+/* Parameters constructor */
+LazyNeuralNetworkEvaluation::LazyNeuralNetworkEvaluation(const PMMLBuffer & buffer,
+    const String & modelName,
+    const NeuralNetwork::EvaluationMode mode,
+    const FileName & cacheFile)
+  : EvaluationImplementation()
+  , p_state_(new State)
+{
+  p_state_->fileName_ = buffer.getFileName();
+  if (p_state_->fileName_.empty())
+    p_state_->p_buffer_ = new PMMLBuffer(buffer);
+  p_state_->modelName_ = modelName;
+  p_state_->mode_ = mode;
+  p_state_->cacheFile_ = cacheFile;
+
+  // Layers are read without their neurons; the checks of NeuralNetworkEvaluation
+  // which only depend on sizes are done now
+  const PMMLNeuralNetwork nnet(PMMLDoc::StreamNeuralNetwork(buffer, modelName, true));
+  setName(nnet.getModelName());
+  inputNames_ = nnet.getNeuralInputNames();
+  outputNames_ = nnet.getNeuralOutputNames();
+  const UnsignedInteger numberOfLayers = nnet.getNumberOfLayers();
+  if (numberOfLayers == 0)
+    throw InvalidArgumentException(HERE) << "Error: a neural network must have at least one layer";
+  layerSizes_ = Indices(1, nnet.getNumberOfInputs());
+  if (layerSizes_[0] == 0)
+    throw InvalidArgumentException(HERE) << "Error: a neural network must have at least one input";
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    const UnsignedInteger width = nnet.getLayerSize(layer);
+    if (width == 0)
+      throw InvalidArgumentException(HERE) << "Error: layer " << layer << " has no neuron";
+    layerSizes_.add(width);
+    activations_.add(nnet.getActivationFunctionAtLayer(layer));
+  }
+  if (nnet.getNumberOfOutputs() != layerSizes_[numberOfLayers])
+    throw InvalidArgumentException(HERE) << "Error: output denormalization has dimension " << nnet.getNumberOfOutputs() << ", expected " << layerSizes_[numberOfLayers];
+  setInputDescription(Description::BuildDefault(getInputDimension(), "x"));
+  setOutputDescription(Description::BuildDefault(getOutputDimension(), "y"));
+}
+
+/* Virtual constructor */
+LazyNeuralNetworkEvaluation * LazyNeuralNetworkEvaluation::clone() const
+{
+  return new LazyNeuralNetworkEvaluation(*this);
+}
+
+/* Function built from the PMML document */
+const Function & LazyNeuralNetworkEvaluation::getFunction() const
+{
+  State & state = *p_state_;
+  // If building fails, the next call tries again
+  std::call_once(state.once_, [this, &state]()
+  {
+    const Function function(NeuralNetwork::BuildFunction(state.p_buffer_.isNull() ? PMMLBuffer::MapFile(state.fileName_) : *state.p_buffer_,
+                            state.modelName_, state.mode_, state.cacheFile_));
+    if ((function.getInputDimension() != getInputDimension()) || (function.getOutputDimension() != getOutputDimension()))
+      throw InvalidArgumentException(HERE) << "Error: neural network " << getName() << " of " << state.fileName_ << " has changed since its header was read";
+    state.function_ = function;
+    state.loaded_ = true;
+  });
+  return state.function_;
+}
+
+/* Evaluation mode of the network once it is built */
+NeuralNetwork::EvaluationMode LazyNeuralNetworkEvaluation::getMode() const
+{
+  return p_state_->mode_;
+}
+
+/* Whether the network has been built */
+Bool LazyNeuralNetworkEvaluation::isLoaded() const
+{
+  return p_state_->loaded_;
+}
+
+/* Operator () */
+Point LazyNeuralNetworkEvaluation::operator() (const Point & inP) const
+{
+  const Point result(getFunction()(inP));
+  callsNumber_.increment();
+  return result;
+}
+
+Sample LazyNeuralNetworkEvaluation::operator() (const Sample & inS) const
+{
+  const Sample result(getFunction()(inS));
+  callsNumber_.fetchAndAdd(inS.getSize());
+  return result;
+}
+
+/* Accessor for input point dimension */
+UnsignedInteger LazyNeuralNetworkEvaluation::getInputDimension() const
+{
+  return layerSizes_[0];
+}
+
+/* Accessor for output point dimension */
+UnsignedInteger LazyNeuralNetworkEvaluation::getOutputDimension() const
+{
+  return layerSizes_[layerSizes_.getSize() - 1];
+}
+
+/* Names of the fields read by <NeuralInput> elements */
+Description LazyNeuralNetworkEvaluation::getNeuralInputNames() const
+{
+  return inputNames_;
+}
+
+/* Names of the fields written by <NeuralOutput> elements */
+Description LazyNeuralNetworkEvaluation::getNeuralOutputNames() const
+{
+  return outputNames_;
+}
+
+/* Input dimension followed by the number of neurons of each layer */
+Indices LazyNeuralNetworkEvaluation::getLayerSizes() const
+{
+  return layerSizes_;
+}
+
+/* Activation function name of each layer */
+Description LazyNeuralNetworkEvaluation::getActivations() const
+{
+  return activations_;
+}
+
+/* String converter */
+String LazyNeuralNetworkEvaluation::__repr__() const
+{
+  return OSS(true) << "class=" << LazyNeuralNetworkEvaluation::GetClassName()
+         << " name=" << getName()
+         << " fileName=" << p_state_->fileName_
+         << " neuralInputNames=" << inputNames_
+         << " neuralOutputNames=" << outputNames_
+         << " layerSizes=" << layerSizes_
+         << " activations=" << activations_
+         << " loaded=" << isLoaded();
+}
+
+String LazyNeuralNetworkEvaluation::__str__(const String & offset) const
+{
+  if (isLoaded())
+    return getFunction().getEvaluation().__str__(offset);
+  OSS oss(false);
+  oss << offset << getClassName() << " : " << layerSizes_[0] << " inputs";
+  for (UnsignedInteger layer = 0; layer < activations_.getSize(); ++layer)
+    oss << " -> " << layerSizes_[layer + 1] << " (" << activations_[layer] << ")";
+  oss << ", not loaded";
+  return oss;
+}
+
+/* Method save() stores the object through the StorageManager */
+void LazyNeuralNetworkEvaluation::save(Advocate & adv) const
+{
+  EvaluationImplementation::save(adv);
+  adv.saveAttribute("fileName_", p_state_->fileName_);
+  adv.saveAttribute("document_", p_state_->p_buffer_.isNull() ? String() : String(p_state_->p_buffer_->getData(), p_state_->p_buffer_->getSize()));
+  adv.saveAttribute("modelName_", p_state_->modelName_);
+  adv.saveAttribute("mode_", static_cast<UnsignedInteger>(p_state_->mode_));
+  adv.saveAttribute("cacheFile_", p_state_->cacheFile_);
+  adv.saveAttribute("inputNames_", inputNames_);
+  adv.saveAttribute("outputNames_", outputNames_);
+  adv.saveAttribute("layerSizes_", layerSizes_);
+  adv.saveAttribute("activations_", activations_);
+}
+
+/* Method load() reloads the object from the StorageManager */
+void LazyNeuralNetworkEvaluation::load(Advocate & adv)
+{
+  EvaluationImplementation::load(adv);
+  // The state may be shared with other evaluations
+  p_state_ = new State;
+  String document;
+  UnsignedInteger mode = 0;
+  adv.loadAttribute("fileName_", p_state_->fileName_);
+  adv.loadAttribute("document_", document);
+  adv.loadAttribute("modelName_", p_state_->modelName_);
+  adv.loadAttribute("mode_", mode);
+  adv.loadAttribute("cacheFile_", p_state_->cacheFile_);
+  adv.loadAttribute("inputNames_", inputNames_);
+  adv.loadAttribute("outputNames_", outputNames_);
+  adv.loadAttribute("layerSizes_", layerSizes_);
+  adv.loadAttribute("activations_", activations_);
+  if (p_state_->fileName_.empty())
+    p_state_->p_buffer_ = new PMMLBuffer(document.data(), document.size());
+  p_state_->mode_ = static_cast<NeuralNetwork::EvaluationMode>(mode);
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,107 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LazyNeuralNetworkGradient.cxx
+ *  @brief Gradient of a neural network built on its first use
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/LazyNeuralNetworkGradient.hxx"
+
+#include <openturns/PersistentObjectFactory.hxx>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(LazyNeuralNetworkGradient)
+
+static const Factory<LazyNeuralNetworkGradient> Factory_LazyNeuralNetworkGradient;
+
+/* Default constructor */
+LazyNeuralNetworkGradient::LazyNeuralNetworkGradient()
+  : GradientImplementation()
+  , p_evaluation_(new LazyNeuralNetworkEvaluation)
+{
+  // Nothing to do
+}
+
+/* Parameters constructor */
+LazyNeuralNetworkGradient::LazyNeuralNetworkGradient(const LazyNeuralNetworkEvaluationPointer & p_evaluation)
+  : GradientImplementation()
+  , p_evaluation_(p_evaluation)
+{
+  // Nothing to do
+}
+
+/* Virtual constructor */
+LazyNeuralNetworkGradient * LazyNeuralNetworkGradient::clone() const
+{
+  return new LazyNeuralNetworkGradient(*this);
+}
+
+/* Gradient method */
+Matrix LazyNeuralNetworkGradient::gradient(const Point & inP) const
+{
+  const Matrix result(p_evaluation_->getFunction().gradient(inP));
+  callsNumber_.increment();
+  return result;
+}
+
+/* Accessor for input point dimension */
+UnsignedInteger LazyNeuralNetworkGradient::getInputDimension() const
+{
+  return p_evaluation_->getInputDimension();
+}
+
+/* Accessor for output point dimension */
+UnsignedInteger LazyNeuralNetworkGradient::getOutputDimension() const
+{
+  return p_evaluation_->getOutputDimension();
+}
+
+/* String converter */
+String LazyNeuralNetworkGradient::__repr__() const
+{
+  return OSS(true) << "class=" << LazyNeuralNetworkGradient::GetClassName()
+         << " name=" << getName()
+         << " evaluation=" << p_evaluation_->__repr__();
+}
+
+String LazyNeuralNetworkGradient::__str__(const String & offset) const
+{
+  return OSS(false) << offset << getClassName() << " of " << p_evaluation_->__str__();
+}
+
+/* Method save() stores the object through the StorageManager */
+void LazyNeuralNetworkGradient::save(Advocate & adv) const
+{
+  GradientImplementation::save(adv);
+  adv.saveAttribute("evaluation_", *p_evaluation_);
+}
+
+/* Method load() reloads the object from the StorageManager */
+void LazyNeuralNetworkGradient::load(Advocate & adv)
+{
+  GradientImplementation::load(adv);
+  LazyNeuralNetworkEvaluation evaluation;
+  adv.loadAttribute("evaluation_", evaluation);
+  p_evaluation_ = LazyNeuralNetworkEvaluationPointer(evaluation.clone());
+}
+
+} /* namespace OTPMML */
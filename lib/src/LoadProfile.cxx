@@ -0,0 +1,125 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LoadProfile.cxx
+ *  @brief Time and memory spent in each phase of a model load
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/LoadProfile.hxx"
+
+#include <openturns/Exception.hxx>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(LoadProfile)
+
+/* Default constructor */
+LoadProfile::LoadProfile()
+  : Object()
+  , wallTimes_(PHASES_NUMBER)
+  , memoryGrowth_(PHASES_NUMBER)
+{
+  // Nothing to do
+}
+
+/* Parameters constructor */
+LoadProfile::LoadProfile(const String & category,
+                         const String & modelName,
+                         const Point & wallTimes,
+                         const Indices & memoryGrowth)
+  : Object()
+  , category_(category)
+  , modelName_(modelName)
+  , wallTimes_(wallTimes)
+  , memoryGrowth_(memoryGrowth)
+{
+  if ((wallTimes.getDimension() != PHASES_NUMBER) || (memoryGrowth.getSize() != PHASES_NUMBER))
+    throw InvalidArgumentException(HERE) << "Error: a load profile needs " << static_cast<UnsignedInteger>(PHASES_NUMBER) << " wall times and memory growths";
+}
+
+/* Category accessor */
+String LoadProfile::getCategory() const
+{
+  return category_;
+}
+
+/* Model name accessor */
+String LoadProfile::getModelName() const
+{
+  return modelName_;
+}
+
+/* Names of the phases */
+Description LoadProfile::GetPhaseNames()
+{
+  Description names(PHASES_NUMBER);
+  names[PARSE] = "parse";
+  names[LOOKUP] = "lookup";
+  names[WEIGHTS] = "weights";
+  names[NORMALIZATION] = "normalization";
+  names[BUILD] = "build";
+  names[CLEANUP] = "cleanup";
+  return names;
+}
+
+/* Wall times accessor */
+Point LoadProfile::getWallTimes() const
+{
+  return wallTimes_;
+}
+
+Scalar LoadProfile::getTotalWallTime() const
+{
+  Scalar total = 0.0;
+  for (UnsignedInteger i = 0; i < wallTimes_.getDimension(); ++i)
+    total += wallTimes_[i];
+  return total;
+}
+
+/* Memory growth accessor */
+Indices LoadProfile::getMemoryGrowth() const
+{
+  return memoryGrowth_;
+}
+
+/* String converter */
+String LoadProfile::__repr__() const
+{
+  return OSS(true) << "class=" << LoadProfile::GetClassName()
+         << " category=" << category_
+         << " modelName=" << modelName_
+         << " phases=" << GetPhaseNames()
+         << " wallTimes=" << wallTimes_
+         << " memoryGrowth=" << memoryGrowth_;
+}
+
+/* String converter */
+String LoadProfile::__str__(const String & offset) const
+{
+  OSS oss(false);
+  oss << offset << "Load of " << category_ << " '" << modelName_ << "' in " << getTotalWallTime() << "s";
+  const Description names(GetPhaseNames());
+  for (UnsignedInteger i = 0; i < names.getSize(); ++i)
+    oss << "\n" << offset << "  " << names[i] << ": " << wallTimes_[i] << "s, memory growth " << memoryGrowth_[i] << " bytes";
+  return oss;
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,84 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LoadProfiler.cxx
+ *  @brief Opt-in profiling of model loads
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/LoadProfiler.hxx"
+
+#include <atomic>
+#include <cstdlib>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+/* Profiling switch, shared by all threads */
+static std::atomic<bool> LoadProfilerEnabled(false);
+
+/* Last profile recorded by each thread */
+static LoadProfile & LastProfile()
+{
+  static thread_local LoadProfile profile;
+  return profile;
+}
+
+/* Whether loads are profiled */
+void LoadProfiler::SetEnabled(const Bool enabled)
+{
+  LoadProfilerEnabled = enabled;
+}
+
+Bool LoadProfiler::IsEnabled()
+{
+  return LoadProfilerEnabled;
+}
+
+/* Profile of the last load completed by the calling thread */
+LoadProfile LoadProfiler::GetLastProfile()
+{
+  return LastProfile();
+}
+
+void LoadProfiler::SetLastProfile(const LoadProfile & profile)
+{
+  LastProfile() = profile;
+}
+
+/* Heap memory in use by the process */
+UnsignedInteger LoadProfiler::GetHeapMemoryUsage()
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  const struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+  // Counters of mallinfo are int, they wrap around above 2 GiB
+  const struct mallinfo info = mallinfo();
+  return static_cast<unsigned int>(info.uordblks) + static_cast<unsigned int>(info.hblkhd);
+#else
+  return 0;
+#endif
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,126 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LoadRecorder.hxx
+ *  @brief Records the phases of a model load
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+// This file is not a regular header: it is only included by the sources which
+// load models, it is not installed.
+
+#ifndef OTPMML_LOADRECORDER_HXX
+#define OTPMML_LOADRECORDER_HXX
+
+#include "otpmml/LoadProfiler.hxx"
+
+#include <chrono>
+
+namespace OTPMML
+{
+
+/* A recorder lives during the load of a model, and publishes its profile when it is
+   destroyed.  Code called during the load marks phases with StartPhase, which does
+   nothing if no load is recorded by the calling thread; each phase lasts until the
+   next one starts */
+class LoadRecorder
+{
+public:
+  LoadRecorder(const OT::String & category, const OT::String & modelName)
+    : enabled_(LoadProfiler::IsEnabled())
+    , previous_(Current())
+    , category_(category)
+    , modelName_(modelName)
+    , phase_(LoadProfile::PHASES_NUMBER)
+    , phaseMemory_(0)
+  {
+    if (!enabled_) return;
+    wallTimes_ = OT::Point(LoadProfile::PHASES_NUMBER);
+    memoryGrowth_ = OT::Indices(LoadProfile::PHASES_NUMBER);
+    Current() = this;
+    start(LoadProfile::LOOKUP);
+  }
+
+  ~LoadRecorder()
+  {
+    if (!enabled_) return;
+    stop();
+    Current() = previous_;
+    try
+    {
+      LoadProfiler::SetLastProfile(LoadProfile(category_, modelName_, wallTimes_, memoryGrowth_));
+    }
+    catch (...)
+    {
+      // A profile is not worth an exception
+    }
+  }
+
+  /* Start a phase of the load recorded by the calling thread, if any */
+  static void StartPhase(const LoadProfile::Phase phase)
+  {
+    LoadRecorder * p_recorder = Current();
+    if (p_recorder) p_recorder->start(phase);
+  }
+
+private:
+  LoadRecorder(const LoadRecorder &);
+  LoadRecorder & operator=(const LoadRecorder &);
+
+  static LoadRecorder *& Current()
+  {
+    static thread_local LoadRecorder * p_current = NULL;
+    return p_current;
+  }
+
+  /* Reading the heap usage walks all the arenas, so the current phase simply goes on
+     when it is started again, for instance for each layer */
+  void start(const LoadProfile::Phase phase)
+  {
+    if (phase == phase_) return;
+    stop();
+    phase_ = phase;
+    phaseMemory_ = LoadProfiler::GetHeapMemoryUsage();
+    phaseStart_ = std::chrono::steady_clock::now();
+  }
+
+  /* Each phase is charged with the growth of the heap usage since it started */
+  void stop()
+  {
+    if (phase_ == LoadProfile::PHASES_NUMBER) return;
+    wallTimes_[phase_] += std::chrono::duration<OT::Scalar>(std::chrono::steady_clock::now() - phaseStart_).count();
+    const OT::UnsignedInteger usage = LoadProfiler::GetHeapMemoryUsage();
+    if (usage > phaseMemory_)
+      memoryGrowth_[phase_] += usage - phaseMemory_;
+    phase_ = LoadProfile::PHASES_NUMBER;
+  }
+
+  const OT::Bool enabled_;
+  LoadRecorder * const previous_;
+  const OT::String category_;
+  const OT::String modelName_;
+  LoadProfile::Phase phase_;
+  std::chrono::steady_clock::time_point phaseStart_;
+  OT::UnsignedInteger phaseMemory_;
+  OT::Point wallTimes_;
+  OT::Indices memoryGrowth_;
+};
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_LOADRECORDER_HXX */
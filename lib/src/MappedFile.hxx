@@ -0,0 +1,113 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  MappedFile.hxx
+ *  @brief Read-only view of a whole file
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+// This file is not a regular header: it is only included by the sources which
+// read whole files, it is not installed.
+
+#ifndef OTPMML_MAPPEDFILE_HXX
+#define OTPMML_MAPPEDFILE_HXX
+
+#include <openturns/OTprivate.hxx>
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace OTPMML
+{
+
+/* Read-only view of a whole file, memory-mapped when the platform allows it.
+   error_ holds errno if the file cannot be opened, and is 0 otherwise */
+class MappedFile
+{
+public:
+  explicit MappedFile(const OT::FileName & fileName)
+    : data_(NULL)
+    , size_(0)
+    , error_(0)
+    , mapping_(NULL)
+  {
+#ifdef _WIN32
+    std::ifstream file(fileName.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+      error_ = errno ? errno : ENOENT;
+      return;
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = buffer_.empty() ? NULL : &buffer_[0];
+    size_ = buffer_.size();
+#else
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      error_ = errno;
+      return;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+      void * mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED)
+      {
+        mapping_ = mapping;
+        data_ = static_cast<const char *>(mapping);
+        size_ = status.st_size;
+      }
+      else
+        error_ = errno;
+    }
+    close(fd);
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifndef _WIN32
+    if (mapping_) munmap(mapping_, size_);
+#endif
+  }
+
+  const char * data_;
+  size_t size_;
+  int error_;
+
+private:
+  MappedFile(const MappedFile &);
+  MappedFile & operator=(const MappedFile &);
+
+  void * mapping_;
+  std::vector<char> buffer_;
+};
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_MAPPEDFILE_HXX */
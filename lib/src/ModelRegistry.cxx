@@ -0,0 +1,266 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ModelRegistry.cxx
+ *  @brief Process-wide registry of the models read from PMML files
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/ModelRegistry.hxx"
+
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <mutex>
+
+#include <sys/stat.h>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+/* Default capacity of the registry, in bytes */
+static const UnsignedInteger ModelRegistryDefaultCapacity = 256 * 1024 * 1024;
+
+/* Registered model; only one of evaluation_ and regression_ is used */
+struct ModelRegistryEntry
+{
+  String name_;
+  NeuralNetworkEvaluation evaluation_;
+  Pointer<LinearLeastSquares> regression_;
+  UnsignedInteger memoryUsage_;
+  std::list<String>::iterator lastUse_;
+};
+
+/* State of the registry, guarded by its mutex */
+struct ModelRegistryState
+{
+  ModelRegistryState()
+    : capacity_(ModelRegistryDefaultCapacity)
+    , hits_(0)
+    , misses_(0)
+    , evictions_(0)
+    , memoryUsage_(0)
+  {
+  }
+
+  /** Mark an entry as the most recently used one */
+  void touch(ModelRegistryEntry & entry)
+  {
+    lastUses_.splice(lastUses_.begin(), lastUses_, entry.lastUse_);
+  }
+
+  /** Remove least recently used entries until memory usage fits into capacity */
+  void evict()
+  {
+    while ((memoryUsage_ > capacity_) && !lastUses_.empty())
+    {
+      std::map<String, ModelRegistryEntry>::iterator it = entries_.find(lastUses_.back());
+      memoryUsage_ -= it->second.memoryUsage_;
+      entries_.erase(it);
+      lastUses_.pop_back();
+      ++evictions_;
+    }
+  }
+
+  /** Register an entry, unless another thread has already done it */
+  void add(const String & key, const ModelRegistryEntry & entry)
+  {
+    if (key.empty() || (capacity_ == 0) || (entries_.find(key) != entries_.end())) return;
+    ModelRegistryEntry & newEntry = entries_[key];
+    newEntry = entry;
+    lastUses_.push_front(key);
+    newEntry.lastUse_ = lastUses_.begin();
+    memoryUsage_ += newEntry.memoryUsage_;
+    evict();
+  }
+
+  /** Find an entry and update statistics */
+  ModelRegistryEntry * find(const String & key)
+  {
+    if (key.empty() || (capacity_ == 0)) return NULL;
+    std::map<String, ModelRegistryEntry>::iterator it = entries_.find(key);
+    if (it == entries_.end())
+    {
+      ++misses_;
+      return NULL;
+    }
+    ++hits_;
+    touch(it->second);
+    return &it->second;
+  }
+
+  std::mutex mutex_;
+  std::map<String, ModelRegistryEntry> entries_;
+  /** Keys, from the most recently used to the least recently used */
+  std::list<String> lastUses_;
+  UnsignedInteger capacity_;
+  UnsignedInteger hits_;
+  UnsignedInteger misses_;
+  UnsignedInteger evictions_;
+  UnsignedInteger memoryUsage_;
+};
+
+static ModelRegistryState & GetState()
+{
+  static ModelRegistryState state;
+  return state;
+}
+
+/* Capacity accessor */
+void ModelRegistry::SetCapacity(const UnsignedInteger capacity)
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  state.capacity_ = capacity;
+  state.evict();
+}
+
+UnsignedInteger ModelRegistry::GetCapacity()
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  return state.capacity_;
+}
+
+/* Statistics accessors */
+UnsignedInteger ModelRegistry::GetNumberOfHits()
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  return state.hits_;
+}
+
+UnsignedInteger ModelRegistry::GetNumberOfMisses()
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  return state.misses_;
+}
+
+UnsignedInteger ModelRegistry::GetNumberOfEvictions()
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  return state.evictions_;
+}
+
+UnsignedInteger ModelRegistry::GetNumberOfModels()
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  return state.entries_.size();
+}
+
+UnsignedInteger ModelRegistry::GetMemoryUsage()
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  return state.memoryUsage_;
+}
+
+/* Remove all models and reset statistics */
+void ModelRegistry::Clear()
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  state.entries_.clear();
+  state.lastUses_.clear();
+  state.hits_ = 0;
+  state.misses_ = 0;
+  state.evictions_ = 0;
+  state.memoryUsage_ = 0;
+}
+
+/* Key of a model in a file */
+String ModelRegistry::GetKey(const FileName & pmmlFile, const String & category, const String & modelName)
+{
+  if (GetCapacity() == 0) return String();
+#ifdef _WIN32
+  char * path = _fullpath(NULL, pmmlFile.c_str(), 0);
+#else
+  char * path = realpath(pmmlFile.c_str(), NULL);
+#endif
+  if (path == NULL) return String();
+  const String canonicalPath(path);
+  std::free(path);
+  struct stat status;
+  if (stat(canonicalPath.c_str(), &status) != 0) return String();
+  // Nanoseconds tell apart a file rewritten within the same second
+#if defined(__APPLE__)
+  const UnsignedInteger modificationNanoseconds = status.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+  const UnsignedInteger modificationNanoseconds = 0;
+#else
+  const UnsignedInteger modificationNanoseconds = status.st_mtim.tv_nsec;
+#endif
+  return OSS() << canonicalPath << "\n" << static_cast<UnsignedInteger>(status.st_mtime) << "." << modificationNanoseconds << "\n" << static_cast<UnsignedInteger>(status.st_size) << "\n" << category << "\n" << modelName;
+}
+
+/* Get a registered neural network */
+Bool ModelRegistry::FindNeuralNetwork(const String & key, NeuralNetworkEvaluation & evaluation, String & name)
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  const ModelRegistryEntry * p_entry = state.find(key);
+  if (!p_entry) return false;
+  // The copy shares the compiled network
+  evaluation = p_entry->evaluation_;
+  name = p_entry->name_;
+  return true;
+}
+
+/* Register a neural network */
+void ModelRegistry::AddNeuralNetwork(const String & key, const String & name, const NeuralNetworkEvaluation & evaluation)
+{
+  ModelRegistryEntry entry;
+  entry.name_ = name;
+  entry.evaluation_ = evaluation;
+  entry.memoryUsage_ = evaluation.getMemoryUsage();
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  state.add(key, entry);
+}
+
+/* Get a registered regression model */
+Bool ModelRegistry::FindRegressionModel(const String & key, Pointer<LinearLeastSquares> & regression)
+{
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  const ModelRegistryEntry * p_entry = state.find(key);
+  if (!p_entry) return false;
+  regression = p_entry->regression_;
+  return true;
+}
+
+/* Register a regression model */
+void ModelRegistry::AddRegressionModel(const String & key, const Pointer<LinearLeastSquares> & regression)
+{
+  const Sample dataIn(regression->getDataIn());
+  const Sample dataOut(regression->getDataOut());
+  const Matrix linear(regression->getLinear());
+  ModelRegistryEntry entry;
+  entry.regression_ = regression;
+  entry.memoryUsage_ = sizeof(LinearLeastSquares) + sizeof(Scalar) * (dataIn.getSize() * dataIn.getDimension() + dataOut.getSize() * dataOut.getDimension()
+                       + linear.getNbRows() * linear.getNbColumns() + regression->getConstant().getDimension());
+  ModelRegistryState & state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex_);
+  state.add(key, entry);
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,184 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ModelSet.cxx
+ *  @brief All the models of a PMML file
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/ModelSet.hxx"
+#include "otpmml/PMMLDoc.hxx"
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+#include "otpmml/ModelRegistry.hxx"
+#include "ParallelTasks.hxx"
+
+#include <openturns/Exception.hxx>
+
+#include <vector>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(ModelSet)
+
+/* Default constructor */
+ModelSet::ModelSet(const FileName & pmmlFile, const NeuralNetwork::EvaluationMode mode, const UnsignedInteger numberOfThreads)
+  : ModelSet(PMMLBuffer::MapFile(pmmlFile), mode, numberOfThreads)
+{
+  // Nothing to do
+}
+
+/* Constructor from a buffer */
+ModelSet::ModelSet(const PMMLBuffer & buffer, const NeuralNetwork::EvaluationMode mode, const UnsignedInteger numberOfThreads)
+  : Object()
+{
+  PMMLDoc::PMMLNeuralNetworkCollection nnets;
+  PMMLDoc::PMMLRegressionModelCollection models;
+  PMMLDoc::StreamModels(buffer, nnets, models);
+  // Models read from memory are not registered
+  const FileName pmmlFile(buffer.getFileName());
+
+  const UnsignedInteger size = nnets.getSize();
+  std::vector<Function> functions(size);
+  if ((mode == NeuralNetwork::NATIVE) || (mode == NeuralNetwork::SINGLE_PRECISION))
+  {
+    // Networks are compiled on several threads, errors are rethrown in the order of the networks
+    std::vector<NeuralNetworkEvaluation> evaluations(size);
+    RunTasks(size, GetNumberOfThreads(numberOfThreads), [&](const UnsignedInteger i)
+    {
+      const String name(nnets[i].getModelName());
+      const String key(pmmlFile.empty() ? String() : ModelRegistry::GetKey(pmmlFile, "NeuralNetwork", name));
+      String registeredName;
+      if (!ModelRegistry::FindNeuralNetwork(key, evaluations[i], registeredName))
+      {
+        evaluations[i] = NeuralNetwork::BuildNativeEvaluation(nnets[i]);
+        ModelRegistry::AddNeuralNetwork(key, name, evaluations[i]);
+      }
+    });
+    for (UnsignedInteger i = 0; i < size; ++i)
+      functions[i] = NeuralNetwork::BuildNativeFunction(nnets[i].getModelName(), evaluations[i], mode);
+  }
+  else
+  {
+    // Symbolic functions are built sequentially, parsing formulas is not known to be thread-safe
+    for (UnsignedInteger i = 0; i < size; ++i)
+    {
+      functions[i] = NeuralNetwork::BuildSymbolicFunction(nnets[i]);
+      functions[i].setName(nnets[i].getModelName());
+    }
+  }
+  for (UnsignedInteger i = 0; i < size; ++i)
+    networks_.add(NeuralNetwork(functions[i]));
+
+  // Regression models are cheap to build, and share registered ones
+  for (UnsignedInteger i = 0; i < models.getSize(); ++i)
+  {
+    const String key(pmmlFile.empty() ? String() : ModelRegistry::GetKey(pmmlFile, "RegressionModel", models[i].getModelName()));
+    Pointer<LinearLeastSquares> metamodel;
+    if (!ModelRegistry::FindRegressionModel(key, metamodel))
+    {
+      metamodel = RegressionModel::BuildLinearLeastSquares(models[i]);
+      ModelRegistry::AddRegressionModel(key, metamodel);
+    }
+    regressions_.add(RegressionModel(metamodel));
+  }
+}
+
+/* Neural networks accessors */
+UnsignedInteger ModelSet::getNumberOfNeuralNetworks() const
+{
+  return networks_.getSize();
+}
+
+Description ModelSet::getNeuralNetworkNames() const
+{
+  Description names(networks_.getSize());
+  for (UnsignedInteger i = 0; i < networks_.getSize(); ++i)
+    names[i] = networks_[i].getName();
+  return names;
+}
+
+NeuralNetwork ModelSet::getNeuralNetwork(const UnsignedInteger index) const
+{
+  if (index >= networks_.getSize())
+    throw InvalidArgumentException(HERE) << "Error: neural network index " << index << " must be less than " << networks_.getSize();
+  return networks_[index];
+}
+
+NeuralNetwork ModelSet::getNeuralNetwork(const String & modelName) const
+{
+  for (UnsignedInteger i = 0; i < networks_.getSize(); ++i)
+    if (networks_[i].getName() == modelName)
+      return networks_[i];
+  throw InvalidArgumentException(HERE) << "Unable to find NeuralNetwork named '" << modelName << "', models found are: " << getNeuralNetworkNames();
+}
+
+/* Regression models accessors */
+UnsignedInteger ModelSet::getNumberOfRegressionModels() const
+{
+  return regressions_.getSize();
+}
+
+Description ModelSet::getRegressionModelNames() const
+{
+  Description names(regressions_.getSize());
+  for (UnsignedInteger i = 0; i < regressions_.getSize(); ++i)
+    names[i] = regressions_[i].getLinearLeastSquares().getName();
+  return names;
+}
+
+RegressionModel ModelSet::getRegressionModel(const UnsignedInteger index) const
+{
+  if (index >= regressions_.getSize())
+    throw InvalidArgumentException(HERE) << "Error: regression model index " << index << " must be less than " << regressions_.getSize();
+  return regressions_[index];
+}
+
+RegressionModel ModelSet::getRegressionModel(const String & modelName) const
+{
+  for (UnsignedInteger i = 0; i < regressions_.getSize(); ++i)
+    if (regressions_[i].getLinearLeastSquares().getName() == modelName)
+      return regressions_[i];
+  throw InvalidArgumentException(HERE) << "Unable to find RegressionModel named '" << modelName << "', models found are: " << getRegressionModelNames();
+}
+
+/* All models as functions */
+ModelSet::FunctionCollection ModelSet::getFunctions() const
+{
+  FunctionCollection result;
+  for (UnsignedInteger i = 0; i < networks_.getSize(); ++i)
+    result.add(networks_[i]);
+  for (UnsignedInteger i = 0; i < regressions_.getSize(); ++i)
+  {
+    Function metamodel(regressions_[i].getLinearLeastSquares().getMetaModel());
+    metamodel.setName(regressions_[i].getLinearLeastSquares().getName());
+    result.add(metamodel);
+  }
+  return result;
+}
+
+/* String converter */
+String ModelSet::__repr__() const
+{
+  return OSS(true) << "class=" << ModelSet::GetClassName()
+         << " neuralNetworks=" << getNeuralNetworkNames()
+         << " regressionModels=" << getRegressionModelNames();
+}
+
+} /* namespace OTPMML */
@@ -23,6 +23,15 @@
 #include "otpmml/NeuralNetwork.hxx"
 #include "otpmml/PMMLDoc.hxx"
 #include "otpmml/PMMLNeuralNetwork.hxx"
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+#include "otpmml/NeuralNetworkGradient.hxx"
+#include "otpmml/NeuralNetworkHessian.hxx"
+#include "otpmml/LazyNeuralNetworkGradient.hxx"
+#include "otpmml/LazyNeuralNetworkHessian.hxx"
+#include "otpmml/NeuralNetworkCache.hxx"
+#include "otpmml/ModelRegistry.hxx"
+#include "otpmml/Activation.hxx"
+#include "LoadRecorder.hxx"
 
 #include <openturns/ComposedFunction.hxx>
 
@@ -34,19 +43,368 @@ namespace OTPMML
 CLASSNAMEINIT(NeuralNetwork)
 
 /* Default constructor */
-NeuralNetwork::NeuralNetwork(const FileName & pmmlFile, const String& modelName)
+NeuralNetwork::NeuralNetwork(const FileName & pmmlFile, const String& modelName, const EvaluationMode mode, const FileName & cacheFile, const Bool lazy)
+  : NeuralNetwork(PMMLBuffer::MapFile(pmmlFile), modelName, mode, cacheFile, lazy)
+{
+  // Nothing to do
+}
+
+/* Constructor from a buffer */
+NeuralNetwork::NeuralNetwork(const PMMLBuffer & buffer, const String& modelName, const EvaluationMode mode, const FileName & cacheFile, const Bool lazy)
   : Function()
 {
-  xmlInitParser();
-  PMMLDoc doc(pmmlFile);
-  PMMLNeuralNetwork nnet(doc.getNeuralNetwork(modelName));
-  Function composedFunction(nnet.getInputsNormalizationFunction());
-  for (UnsignedInteger layer = 0; layer < nnet.getNumberOfLayers(); ++layer)
-    composedFunction = ComposedFunction(nnet.getEvaluationFunctionAtLayer(layer), composedFunction);
-  composedFunction = ComposedFunction(nnet.getOutputsNormalizationFunction(), composedFunction);
-  xmlCleanupParser();
-  setName(nnet.getModelName());
-  getImplementation().swap(composedFunction.getImplementation());
+  Function function;
+  if (lazy)
+  {
+    // The gradient and the hessian share the evaluation, which builds the network
+    LoadRecorder recorder("NeuralNetwork", modelName);
+    const LazyNeuralNetworkGradient::LazyNeuralNetworkEvaluationPointer p_evaluation(new LazyNeuralNetworkEvaluation(buffer, modelName, mode, cacheFile));
+    LoadRecorder::StartPhase(LoadProfile::BUILD);
+    function = Function(Evaluation(p_evaluation), LazyNeuralNetworkGradient(p_evaluation), LazyNeuralNetworkHessian(p_evaluation));
+    function.setName(p_evaluation->getName());
+  }
+  else
+    function = BuildFunction(buffer, modelName, mode, cacheFile);
+  getImplementation().swap(function.getImplementation());
+}
+
+/* Read the network and build its Function */
+Function NeuralNetwork::BuildFunction(const PMMLBuffer & buffer, const String & modelName, const EvaluationMode mode, const FileName & cacheFile)
+{
+  LoadRecorder recorder("NeuralNetwork", modelName);
+  Function function;
+  if ((mode == NATIVE) || (mode == SINGLE_PRECISION))
+  {
+    // A network already built from the same file is shared, otherwise the compiled
+    // network is read from the cache if it has been written for the same PMML contents.
+    // Networks read from memory are not registered.
+    const String key(buffer.getFileName().empty() ? String() : ModelRegistry::GetKey(buffer.getFileName(), "NeuralNetwork", modelName));
+    NeuralNetworkEvaluation evaluation;
+    String name;
+    if (!ModelRegistry::FindNeuralNetwork(key, evaluation, name))
+    {
+      const Bool useCache = !cacheFile.empty();
+      const UnsignedInteger sourceHash = useCache ? NeuralNetworkCache::ComputeHash(buffer.getData(), buffer.getSize()) : 0;
+      if (!useCache || !NeuralNetworkCache::Read(cacheFile, sourceHash, modelName, name, evaluation))
+      {
+        // The network is read as a stream, the document tree is never built;
+        // the intermediate model is released as soon as it has been converted
+        {
+          const PMMLNeuralNetwork nnet(PMMLDoc::StreamNeuralNetwork(buffer, modelName));
+          evaluation = BuildNativeEvaluation(nnet);
+          name = nnet.getModelName();
+          LoadRecorder::StartPhase(LoadProfile::CLEANUP);
+        }
+        LoadRecorder::StartPhase(LoadProfile::BUILD);
+        if (useCache && !NeuralNetworkCache::Write(cacheFile, sourceHash, modelName, name, evaluation))
+          LOGWARN(OSS() << "Unable to write neural network cache " << cacheFile);
+      }
+      ModelRegistry::AddNeuralNetwork(key, name, evaluation);
+    }
+    LoadRecorder::StartPhase(LoadProfile::BUILD);
+    function = BuildNativeFunction(name, evaluation, mode);
+  }
+  else
+  {
+    const PMMLNeuralNetwork nnet(PMMLDoc::StreamNeuralNetwork(buffer, modelName));
+    function = BuildSymbolicFunction(nnet);
+    function.setName(nnet.getModelName());
+    LoadRecorder::StartPhase(LoadProfile::CLEANUP);
+  }
+  return function;
+}
+
+/* Constructor from a function built by one of the Build methods */
+NeuralNetwork::NeuralNetwork(const Function & function)
+  : Function(function)
+{
+  // Nothing to do
+}
+
+/* Build a Function from a native evaluation */
+Function NeuralNetwork::BuildNativeFunction(const String & name, const NeuralNetworkEvaluation & evaluation, const EvaluationMode mode)
+{
+  // Evaluation is shared with the gradient and the hessian, and owns its sample settings
+  const NeuralNetworkGradient::NeuralNetworkEvaluationPointer p_evaluation(evaluation.clone());
+  p_evaluation->setSinglePrecision(mode == SINGLE_PRECISION);
+  Function function(Evaluation(p_evaluation), NeuralNetworkGradient(p_evaluation), NeuralNetworkHessian(p_evaluation));
+  function.setName(name);
+  return function;
+}
+
+/* Build a Function by composing a SymbolicFunction for each layer */
+Function NeuralNetwork::BuildSymbolicFunction(const PMMLNeuralNetwork & nnet)
+{
+  // Normalizations are folded into the first and last layers when they are understood,
+  // otherwise they are composed as separate functions
+  LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+  Point inputCenter;
+  Point inputScale;
+  const Bool foldInputs = ComputeInputsNormalization(nnet, inputCenter, inputScale);
+  Point outputScale;
+  Point outputShift;
+  const Bool foldOutputs = ComputeOutputsNormalization(nnet, outputScale, outputShift);
+  LoadRecorder::StartPhase(LoadProfile::BUILD);
+  const UnsignedInteger numberOfLayers = nnet.getNumberOfLayers();
+  Function composedFunction;
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    const Bool first = (layer == 0) && foldInputs;
+    const Bool last = (layer + 1 == numberOfLayers) && foldOutputs;
+    Function layerFunction;
+    if (first || last)
+    {
+      Matrix weights(nnet.getWeightsAtLayer(layer));
+      Point bias(nnet.getBiasAtLayer(layer));
+      if (first)
+        FoldInputsNormalization(inputCenter, inputScale, weights, bias);
+      layerFunction = PMMLNeuralNetwork::BuildLayerFunction(weights, bias, nnet.getActivationFunctionAtLayer(layer), last ? outputScale : Point(), last ? outputShift : Point());
+    }
+    else
+      layerFunction = nnet.getEvaluationFunctionAtLayer(layer);
+    if (layer > 0)
+      composedFunction = ComposedFunction(layerFunction, composedFunction);
+    else if (foldInputs)
+      composedFunction = layerFunction;
+    else
+      composedFunction = ComposedFunction(layerFunction, nnet.getInputsNormalizationFunction());
+  }
+  if (!foldOutputs)
+    composedFunction = ComposedFunction(nnet.getOutputsNormalizationFunction(), composedFunction);
+  return composedFunction;
+}
+
+/* Build a native evaluation */
+NeuralNetworkEvaluation NeuralNetwork::BuildNativeEvaluation(const PMMLNeuralNetwork & nnet)
+{
+  LoadRecorder::StartPhase(LoadProfile::WEIGHTS);
+  const UnsignedInteger numberOfLayers = nnet.getNumberOfLayers();
+  NeuralNetworkEvaluation::MatrixCollection weights(numberOfLayers);
+  NeuralNetworkEvaluation::PointCollection bias(numberOfLayers);
+  Indices activations(numberOfLayers);
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    weights[layer] = nnet.getWeightsAtLayer(layer);
+    bias[layer] = nnet.getBiasAtLayer(layer);
+    activations[layer] = Activation::GetTypeFromName(nnet.getActivationFunctionAtLayer(layer));
+  }
+  LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+  Point inputCenter;
+  Point inputScale;
+  if (ComputeInputsNormalization(nnet, inputCenter, inputScale))
+  {
+    // The first layer reads inputs directly
+    FoldInputsNormalization(inputCenter, inputScale, weights[0], bias[0]);
+    inputCenter = Point(inputCenter.getDimension());
+    inputScale = Point(inputScale.getDimension(), 1.0);
+  }
+  Point outputScale;
+  Point outputShift;
+  ComputeOutputsNormalization(nnet, outputScale, outputShift);
+  LoadRecorder::StartPhase(LoadProfile::BUILD);
+  return NeuralNetworkEvaluation(inputCenter, inputScale, weights, bias, activations, outputScale, outputShift,
+                                 nnet.getNeuralInputNames(), nnet.getNeuralOutputNames());
+}
+
+/* Inputs normalization u = (x - center) * scale */
+Bool NeuralNetwork::ComputeInputsNormalization(const PMMLNeuralNetwork & nnet, Point & center, Point & scale)
+{
+  // Affine maps of getInputsNormalizationFunction, see comments there
+  const Sample input(nnet.getInputsNormalization());
+  const UnsignedInteger dimension = input.getSize();
+  center = Point(dimension);
+  scale = Point(dimension, 1.0);
+  for (UnsignedInteger d = 0; d < dimension; ++d)
+  {
+    if (input(0, 3) == 0.0)
+    {
+      // Case 1: y = (x - orig1) / (- orig1 * norm0)
+      center[d] = input(d, 1);
+      scale[d] = -1.0 / (input(d, 1) * input(d, 2));
+    }
+    else
+    {
+      // Case 2: y = 2.0 * (x - dmin) / (dmax - dmin) - 1
+      center[d] = 0.5 * (input(d, 0) + input(d, 1));
+      scale[d] = 2.0 / (input(d, 1) - input(d, 0));
+    }
+  }
+  return PMMLNeuralNetwork::GetNormalizationType(input) != 0;
+}
+
+/* Outputs denormalization x = y * scale + shift */
+Bool NeuralNetwork::ComputeOutputsNormalization(const PMMLNeuralNetwork & nnet, Point & scale, Point & shift)
+{
+  // Affine maps of getOutputsNormalizationFunction, see comments there
+  const Sample output(nnet.getOutputsNormalization());
+  const UnsignedInteger dimension = output.getSize();
+  scale = Point(dimension, 1.0);
+  shift = Point(dimension);
+  for (UnsignedInteger d = 0; d < dimension; ++d)
+  {
+    if (output(0, 3) == 0.0)
+    {
+      // Case 1: x = - y * (orig1 * norm0) + orig1
+      scale[d] = -output(d, 1) * output(d, 2);
+      shift[d] = output(d, 1);
+    }
+    else
+    {
+      // Case 2: x = dmin + 0.5 * (dmax - dmin) * (y + 1)
+      scale[d] = 0.5 * (output(d, 1) - output(d, 0));
+      shift[d] = output(d, 0) + scale[d];
+    }
+  }
+  return PMMLNeuralNetwork::GetNormalizationType(output) != 0;
+}
+
+/* Fold inputs normalization into weights and bias of the first layer */
+void NeuralNetwork::FoldInputsNormalization(const Point & center, const Point & scale, Matrix & weights, Point & bias)
+{
+  // sum_k w_ki (x_k - c_k) s_k + b_i = sum_k (w_ki s_k) x_k + (b_i - sum_k w_ki s_k c_k)
+  for (UnsignedInteger i = 0; i < weights.getNbColumns(); ++i)
+    for (UnsignedInteger k = 0; k < weights.getNbRows(); ++k)
+    {
+      weights(k, i) *= scale[k];
+      bias[i] -= weights(k, i) * center[k];
+    }
+}
+
+/* Hessian at each point of a sample */
+NeuralNetwork::SymmetricTensorCollection NeuralNetwork::hessian(const Sample & inS) const
+{
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  if (p_lazyEvaluation)
+    return NeuralNetwork(p_lazyEvaluation->getFunction()).hessian(inS);
+  const NeuralNetworkHessian * p_hessian = dynamic_cast<const NeuralNetworkHessian *>(getHessian().getImplementation().get());
+  if (p_hessian)
+    return p_hessian->hessian(inS);
+  const UnsignedInteger size = inS.getSize();
+  SymmetricTensorCollection result(size);
+  for (UnsignedInteger i = 0; i < size; ++i)
+    result[i] = hessian(inS[i]);
+  return result;
+}
+
+/* Native evaluation, shared by all copies of this function */
+const NeuralNetworkEvaluation * NeuralNetwork::getNativeEvaluation() const
+{
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  const NeuralNetworkEvaluation * p_evaluation = dynamic_cast<const NeuralNetworkEvaluation *>(p_lazyEvaluation ? p_lazyEvaluation->getFunction().getEvaluation().getImplementation().get() : getEvaluation().getImplementation().get());
+  if (!p_evaluation)
+    throw InvalidArgumentException(HERE) << "Error: sample evaluation settings are not available in SYMBOLIC mode";
+  return p_evaluation;
+}
+
+/* Evaluation holding the sample settings */
+const NeuralNetworkEvaluation & NeuralNetwork::getSettingsEvaluation() const
+{
+  // A lazy network which is not built yet has the default settings, it is not built to read them
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  if (p_lazyEvaluation && !p_lazyEvaluation->isLoaded())
+  {
+    if (p_lazyEvaluation->getMode() == SYMBOLIC)
+      throw InvalidArgumentException(HERE) << "Error: sample evaluation settings are not available in SYMBOLIC mode";
+    static const NeuralNetworkEvaluation defaultSettings;
+    return defaultSettings;
+  }
+  return *getNativeEvaluation();
+}
+
+/* Replace the native evaluation by one with other settings */
+void NeuralNetwork::setNativeEvaluation(const NeuralNetworkEvaluation & evaluation)
+{
+  // Other copies of this function keep the evaluation they share
+  Function function(BuildNativeFunction(getName(), evaluation, evaluation.isSinglePrecision() ? SINGLE_PRECISION : NATIVE));
+  getImplementation().swap(function.getImplementation());
+}
+
+/* Lazy evaluation, null if the network is not lazy */
+const LazyNeuralNetworkEvaluation * NeuralNetwork::getLazyEvaluation() const
+{
+  return dynamic_cast<const LazyNeuralNetworkEvaluation *>(getEvaluation().getImplementation().get());
+}
+
+/* Block size accessor */
+void NeuralNetwork::setBlockSize(const UnsignedInteger blockSize)
+{
+  // The evaluation is copied, its network is shared
+  NeuralNetworkEvaluation evaluation(*getNativeEvaluation());
+  evaluation.setBlockSize(blockSize);
+  setNativeEvaluation(evaluation);
+}
+
+UnsignedInteger NeuralNetwork::getBlockSize() const
+{
+  return getSettingsEvaluation().getBlockSize();
+}
+
+/* Number of threads accessor */
+void NeuralNetwork::setNumberOfThreads(const UnsignedInteger numberOfThreads)
+{
+  NeuralNetworkEvaluation evaluation(*getNativeEvaluation());
+  evaluation.setNumberOfThreads(numberOfThreads);
+  setNativeEvaluation(evaluation);
+}
+
+UnsignedInteger NeuralNetwork::getNumberOfThreads() const
+{
+  return getSettingsEvaluation().getNumberOfThreads();
+}
+
+/* Layers accessors */
+Indices NeuralNetwork::getLayerSizes() const
+{
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  if (p_lazyEvaluation)
+    return p_lazyEvaluation->getLayerSizes();
+  const NeuralNetworkEvaluation * p_evaluation = getNativeEvaluation();
+  Indices layerSizes(1, p_evaluation->getInputDimension());
+  for (UnsignedInteger layer = 0; layer < p_evaluation->getNumberOfLayers(); ++layer)
+    layerSizes.add(p_evaluation->getLayerSize(layer));
+  return layerSizes;
+}
+
+Description NeuralNetwork::getActivations() const
+{
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  if (p_lazyEvaluation)
+    return p_lazyEvaluation->getActivations();
+  const NeuralNetworkEvaluation * p_evaluation = getNativeEvaluation();
+  Description activations(p_evaluation->getNumberOfLayers());
+  for (UnsignedInteger layer = 0; layer < activations.getSize(); ++layer)
+    activations[layer] = Activation::GetName(p_evaluation->getActivationAtLayer(layer));
+  return activations;
+}
+
+/* Fields accessors */
+Description NeuralNetwork::getNeuralInputNames() const
+{
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  if (p_lazyEvaluation)
+    return p_lazyEvaluation->getNeuralInputNames();
+  return getNativeEvaluation()->getNeuralInputNames();
+}
+
+Description NeuralNetwork::getNeuralOutputNames() const
+{
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  if (p_lazyEvaluation)
+    return p_lazyEvaluation->getNeuralOutputNames();
+  return getNativeEvaluation()->getNeuralOutputNames();
+}
+
+/* Whether the network has been built */
+Bool NeuralNetwork::isLoaded() const
+{
+  const LazyNeuralNetworkEvaluation * p_lazyEvaluation = getLazyEvaluation();
+  return !p_lazyEvaluation || p_lazyEvaluation->isLoaded();
+}
+
+/* Maximum absolute deviation of each output between single and double precision evaluations of a sample */
+Point NeuralNetwork::computeSinglePrecisionDeviation(const Sample & inS) const
+{
+  return getNativeEvaluation()->computeSinglePrecisionDeviation(inS);
 }
 
 /* String converter */
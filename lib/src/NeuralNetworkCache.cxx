@@ -0,0 +1,359 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkCache.cxx
+ *  @brief Binary cache of a compiled neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/NeuralNetworkCache.hxx"
+#include "MappedFile.hxx"
+
+#include <openturns/Exception.hxx>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+/* Magic string and format version at the beginning of cache files */
+static const char NeuralNetworkCacheMagic[8] = {'O', 'T', 'P', 'M', 'M', 'L', 'N', 'N'};
+static const uint64_t NeuralNetworkCacheVersion = 2;
+
+/* Number of cache files written by this process, which makes temporary file names unique */
+static std::atomic<UnsignedInteger> NeuralNetworkCacheWrites(0);
+
+/* Header words, followed by the size of each array */
+enum NeuralNetworkCacheHeader { MAGIC_WORD = 0, VERSION_WORD, HASH_WORD, HEADER_SIZE };
+
+/* Arrays stored after the header, in file order; strings are padded to whole words,
+   and names of the fields are stored as a string in which each name ends with a null character */
+enum NeuralNetworkCacheArray
+{
+  MODEL_NAME = 0,
+  NAME,
+  LAYER_SIZES,
+  ACTIVATIONS,
+  WEIGHTS,
+  SPARSE_LAYERS,
+  SPARSE_WEIGHTS,
+  SPARSE_COLUMNS,
+  SPARSE_ROWS,
+  BIAS,
+  INPUT_CENTER,
+  INPUT_SCALE,
+  OUTPUT_SCALE,
+  OUTPUT_SHIFT,
+  NEURAL_INPUT_NAMES,
+  NEURAL_OUTPUT_NAMES,
+  NUMBER_OF_ARRAYS
+};
+
+/* Number of words used to store an array */
+static uint64_t GetNumberOfWords(const UnsignedInteger array, const uint64_t size)
+{
+  return (array == MODEL_NAME || array == NAME || array == NEURAL_INPUT_NAMES || array == NEURAL_OUTPUT_NAMES) ? (size + 7) / 8 : size;
+}
+
+static void WriteString(std::ofstream & file, const String & value)
+{
+  const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  file.write(value.data(), value.size());
+  file.write(padding, GetNumberOfWords(NAME, value.size()) * 8 - value.size());
+}
+
+static String JoinNames(const Description & names)
+{
+  String joined;
+  for (UnsignedInteger i = 0; i < names.getSize(); ++i)
+  {
+    joined += names[i];
+    joined += '\0';
+  }
+  return joined;
+}
+
+static void WriteIndices(std::ofstream & file, const Indices & values)
+{
+  for (UnsignedInteger i = 0; i < values.getSize(); ++i)
+  {
+    const uint64_t word = values[i];
+    file.write(reinterpret_cast<const char *>(&word), sizeof(word));
+  }
+}
+
+static void WritePoint(std::ofstream & file, const Point & values)
+{
+  if (values.getDimension() > 0)
+    file.write(reinterpret_cast<const char *>(&values[0]), values.getDimension() * sizeof(Scalar));
+}
+
+static String ReadString(const char * data, const uint64_t size)
+{
+  return String(data, size);
+}
+
+static Description ReadNames(const char * data, const uint64_t size)
+{
+  Description names;
+  uint64_t start = 0;
+  for (uint64_t i = 0; i < size; ++i)
+    if (data[i] == '\0')
+    {
+      names.add(String(data + start, i - start));
+      start = i + 1;
+    }
+  return names;
+}
+
+static Indices ReadIndices(const char * data, const uint64_t size)
+{
+  Indices values(size);
+  for (UnsignedInteger i = 0; i < size; ++i)
+  {
+    uint64_t word = 0;
+    std::memcpy(&word, data + 8 * i, sizeof(word));
+    values[i] = word;
+  }
+  return values;
+}
+
+static Point ReadPoint(const char * data, const uint64_t size)
+{
+  Point values(size);
+  if (size > 0)
+    std::memcpy(&values[0], data, size * sizeof(Scalar));
+  return values;
+}
+
+/* Hash of a byte buffer (64-bit FNV-1a) */
+UnsignedInteger NeuralNetworkCache::ComputeHash(const char * data, const UnsignedInteger size)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (UnsignedInteger i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/* Hash of the contents of a file */
+UnsignedInteger NeuralNetworkCache::ComputeFileHash(const FileName & fileName)
+{
+  const MappedFile file(fileName);
+  return ComputeHash(file.data_, file.size_);
+}
+
+/* Write an evaluation into a cache file */
+Bool NeuralNetworkCache::Write(const FileName & cacheFile,
+                               const UnsignedInteger sourceHash,
+                               const String & modelName,
+                               const String & name,
+                               const NeuralNetworkEvaluation & evaluation)
+{
+  const NeuralNetworkEvaluation::Network & network = *evaluation.p_network_;
+  uint64_t header[HEADER_SIZE + NUMBER_OF_ARRAYS];
+  std::memcpy(&header[MAGIC_WORD], NeuralNetworkCacheMagic, 8);
+  header[VERSION_WORD] = NeuralNetworkCacheVersion;
+  header[HASH_WORD] = sourceHash;
+  uint64_t * sizes = header + HEADER_SIZE;
+  sizes[MODEL_NAME] = modelName.size();
+  sizes[NAME] = name.size();
+  sizes[LAYER_SIZES] = network.layerSizes_.getSize();
+  sizes[ACTIVATIONS] = network.activations_.getSize();
+  sizes[WEIGHTS] = network.weights_.getDimension();
+  sizes[SPARSE_LAYERS] = network.sparseLayers_.getSize();
+  sizes[SPARSE_WEIGHTS] = network.sparseWeights_.getDimension();
+  sizes[SPARSE_COLUMNS] = network.sparseColumns_.getSize();
+  sizes[SPARSE_ROWS] = network.sparseRows_.getSize();
+  sizes[BIAS] = network.bias_.getDimension();
+  sizes[INPUT_CENTER] = network.inputCenter_.getDimension();
+  sizes[INPUT_SCALE] = network.inputScale_.getDimension();
+  sizes[OUTPUT_SCALE] = network.outputScale_.getDimension();
+  sizes[OUTPUT_SHIFT] = network.outputShift_.getDimension();
+  const String neuralInputNames(JoinNames(network.neuralInputNames_));
+  const String neuralOutputNames(JoinNames(network.neuralOutputNames_));
+  sizes[NEURAL_INPUT_NAMES] = neuralInputNames.size();
+  sizes[NEURAL_OUTPUT_NAMES] = neuralOutputNames.size();
+
+  // Write into a temporary file which is then renamed, so that a concurrent
+  // reader never sees a partial cache; the name is unique to this process and write
+  const UnsignedInteger writeIndex = NeuralNetworkCacheWrites++;
+#ifdef _WIN32
+  const String temporaryFile(OSS() << cacheFile << "." << _getpid() << "." << writeIndex << ".tmp");
+#else
+  const String temporaryFile(OSS() << cacheFile << "." << getpid() << "." << writeIndex << ".tmp");
+#endif
+  std::ofstream file(temporaryFile.c_str(), std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+    return false;
+  file.write(reinterpret_cast<const char *>(header), sizeof(header));
+  WriteString(file, modelName);
+  WriteString(file, name);
+  WriteIndices(file, network.layerSizes_);
+  WriteIndices(file, network.activations_);
+  WritePoint(file, network.weights_);
+  WriteIndices(file, network.sparseLayers_);
+  WritePoint(file, network.sparseWeights_);
+  WriteIndices(file, network.sparseColumns_);
+  WriteIndices(file, network.sparseRows_);
+  WritePoint(file, network.bias_);
+  WritePoint(file, network.inputCenter_);
+  WritePoint(file, network.inputScale_);
+  WritePoint(file, network.outputScale_);
+  WritePoint(file, network.outputShift_);
+  WriteString(file, neuralInputNames);
+  WriteString(file, neuralOutputNames);
+  file.close();
+  if (file.fail())
+  {
+    std::remove(temporaryFile.c_str());
+    return false;
+  }
+#ifdef _WIN32
+  // rename does not replace an existing file
+  std::remove(cacheFile.c_str());
+#endif
+  if (std::rename(temporaryFile.c_str(), cacheFile.c_str()) != 0)
+  {
+    std::remove(temporaryFile.c_str());
+    return false;
+  }
+  return true;
+}
+
+/* Read an evaluation from a cache file */
+Bool NeuralNetworkCache::Read(const FileName & cacheFile,
+                              const UnsignedInteger sourceHash,
+                              const String & modelName,
+                              String & name,
+                              NeuralNetworkEvaluation & evaluation)
+{
+  const MappedFile file(cacheFile);
+  uint64_t header[HEADER_SIZE + NUMBER_OF_ARRAYS];
+  if (file.size_ < sizeof(header))
+    return false;
+  std::memcpy(header, file.data_, sizeof(header));
+  if ((std::memcmp(&header[MAGIC_WORD], NeuralNetworkCacheMagic, 8) != 0) || (header[VERSION_WORD] != NeuralNetworkCacheVersion))
+    return false;
+  if (header[HASH_WORD] != static_cast<uint64_t>(sourceHash))
+    return false;
+
+  // Check that the file holds exactly the announced arrays
+  const uint64_t * sizes = header + HEADER_SIZE;
+  const uint64_t fileWords = file.size_ / 8;
+  uint64_t numberOfWords = HEADER_SIZE + NUMBER_OF_ARRAYS;
+  for (UnsignedInteger array = 0; array < NUMBER_OF_ARRAYS; ++array)
+  {
+    if (sizes[array] > file.size_)
+      return false;
+    numberOfWords += GetNumberOfWords(array, sizes[array]);
+  }
+  if ((numberOfWords != fileWords) || (file.size_ % 8 != 0))
+    return false;
+
+  const char * arrays[NUMBER_OF_ARRAYS];
+  const char * data = file.data_ + sizeof(header);
+  for (UnsignedInteger array = 0; array < NUMBER_OF_ARRAYS; ++array)
+  {
+    arrays[array] = data;
+    data += 8 * GetNumberOfWords(array, sizes[array]);
+  }
+  if (ReadString(arrays[MODEL_NAME], sizes[MODEL_NAME]) != modelName)
+    return false;
+
+  const Indices layerSizes(ReadIndices(arrays[LAYER_SIZES], sizes[LAYER_SIZES]));
+  const Indices activations(ReadIndices(arrays[ACTIVATIONS], sizes[ACTIVATIONS]));
+  const Indices sparseLayers(ReadIndices(arrays[SPARSE_LAYERS], sizes[SPARSE_LAYERS]));
+  const Indices sparseColumns(ReadIndices(arrays[SPARSE_COLUMNS], sizes[SPARSE_COLUMNS]));
+  const Indices sparseRows(ReadIndices(arrays[SPARSE_ROWS], sizes[SPARSE_ROWS]));
+
+  // Check consistency of array sizes, as the evaluation does not check its indices
+  const UnsignedInteger numberOfLayers = activations.getSize();
+  if ((numberOfLayers == 0) || (layerSizes.getSize() != numberOfLayers + 1) || (sparseLayers.getSize() != numberOfLayers))
+    return false;
+  if ((sizes[INPUT_CENTER] != layerSizes[0]) || (sizes[INPUT_SCALE] != layerSizes[0]))
+    return false;
+  if ((sizes[OUTPUT_SCALE] != layerSizes[numberOfLayers]) || (sizes[OUTPUT_SHIFT] != layerSizes[numberOfLayers]))
+    return false;
+  UnsignedInteger numberOfWeights = 0;
+  UnsignedInteger numberOfSparseRows = 0;
+  UnsignedInteger numberOfBias = 0;
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    if (sparseLayers[layer])
+    {
+      for (UnsignedInteger i = numberOfSparseRows; i <= numberOfSparseRows + layerSizes[layer + 1]; ++i)
+        if ((i >= sparseRows.getSize()) || (sparseRows[i] > sizes[SPARSE_WEIGHTS]))
+          return false;
+      for (UnsignedInteger k = sparseRows[numberOfSparseRows]; k < sparseRows[numberOfSparseRows + layerSizes[layer + 1]]; ++k)
+        if ((k >= sparseColumns.getSize()) || (sparseColumns[k] >= layerSizes[layer]))
+          return false;
+      numberOfSparseRows += layerSizes[layer + 1] + 1;
+    }
+    else
+      numberOfWeights += layerSizes[layer] * layerSizes[layer + 1];
+    numberOfBias += layerSizes[layer + 1];
+  }
+  if ((sizes[WEIGHTS] != numberOfWeights) || (sparseRows.getSize() != numberOfSparseRows) || (sizes[BIAS] != numberOfBias))
+    return false;
+  if (sparseColumns.getSize() != sizes[SPARSE_WEIGHTS])
+    return false;
+  const Description neuralInputNames(ReadNames(arrays[NEURAL_INPUT_NAMES], sizes[NEURAL_INPUT_NAMES]));
+  const Description neuralOutputNames(ReadNames(arrays[NEURAL_OUTPUT_NAMES], sizes[NEURAL_OUTPUT_NAMES]));
+  if ((neuralInputNames.getSize() != 0) && (neuralInputNames.getSize() != layerSizes[0]))
+    return false;
+  if ((neuralOutputNames.getSize() != 0) && (neuralOutputNames.getSize() != layerSizes[numberOfLayers]))
+    return false;
+
+  name = ReadString(arrays[NAME], sizes[NAME]);
+  evaluation = NeuralNetworkEvaluation();
+  NeuralNetworkEvaluation::Network & network = *evaluation.p_network_;
+  network.layerSizes_ = layerSizes;
+  network.activations_ = activations;
+  network.weights_ = ReadPoint(arrays[WEIGHTS], sizes[WEIGHTS]);
+  network.sparseLayers_ = sparseLayers;
+  network.sparseWeights_ = ReadPoint(arrays[SPARSE_WEIGHTS], sizes[SPARSE_WEIGHTS]);
+  network.sparseColumns_ = sparseColumns;
+  network.sparseRows_ = sparseRows;
+  network.bias_ = ReadPoint(arrays[BIAS], sizes[BIAS]);
+  network.inputCenter_ = ReadPoint(arrays[INPUT_CENTER], sizes[INPUT_CENTER]);
+  network.inputScale_ = ReadPoint(arrays[INPUT_SCALE], sizes[INPUT_SCALE]);
+  network.outputScale_ = ReadPoint(arrays[OUTPUT_SCALE], sizes[OUTPUT_SCALE]);
+  network.outputShift_ = ReadPoint(arrays[OUTPUT_SHIFT], sizes[OUTPUT_SHIFT]);
+  network.neuralInputNames_ = neuralInputNames;
+  network.neuralOutputNames_ = neuralOutputNames;
+  evaluation.computeOffsets();
+  evaluation.setInputDescription(Description::BuildDefault(layerSizes[0], "x"));
+  evaluation.setOutputDescription(Description::BuildDefault(layerSizes[numberOfLayers], "y"));
+  return true;
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,699 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkEvaluation.cxx
+ *  @brief Native evaluation of a feed-forward neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+#include "otpmml/Activation.hxx"
+#include "ParallelTasks.hxx"
+
+#include <openturns/PersistentObjectFactory.hxx>
+#include <openturns/Exception.hxx>
+#include <openturns/TBBImplementation.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(NeuralNetworkEvaluation)
+
+static const Factory<NeuralNetworkEvaluation> Factory_NeuralNetworkEvaluation;
+
+/* Default number of points evaluated together by operator()(Sample) */
+static const UnsignedInteger NeuralNetworkEvaluationDefaultBlockSize = 256;
+
+/* Largest fraction of non zero weights for which a layer is stored as a sparse matrix */
+static const Scalar NeuralNetworkEvaluationSparseDensity = 0.25;
+
+/* Default constructor */
+NeuralNetworkEvaluation::NeuralNetworkEvaluation()
+  : EvaluationImplementation()
+  , p_network_(new Network)
+  , blockSize_(NeuralNetworkEvaluationDefaultBlockSize)
+  , numberOfThreads_(0)
+  , singlePrecision_(false)
+{
+  // Nothing to do
+}
+
+/* Parameters constructor */
+NeuralNetworkEvaluation::NeuralNetworkEvaluation(const Point & inputCenter,
+    const Point & inputScale,
+    const MatrixCollection & weights,
+    const PointCollection & bias,
+    const Indices & activations,
+    const Point & outputScale,
+    const Point & outputShift,
+    const Description & neuralInputNames,
+    const Description & neuralOutputNames)
+  : EvaluationImplementation()
+  , p_network_(new Network)
+  , blockSize_(NeuralNetworkEvaluationDefaultBlockSize)
+  , numberOfThreads_(0)
+  , singlePrecision_(false)
+{
+  p_network_->layerSizes_ = Indices(1, inputCenter.getDimension());
+  p_network_->activations_ = activations;
+  p_network_->inputCenter_ = inputCenter;
+  p_network_->inputScale_ = inputScale;
+  p_network_->outputScale_ = outputScale;
+  p_network_->outputShift_ = outputShift;
+  const UnsignedInteger numberOfLayers = weights.getSize();
+  if (numberOfLayers == 0)
+    throw InvalidArgumentException(HERE) << "Error: a neural network must have at least one layer";
+  if ((bias.getSize() != numberOfLayers) || (activations.getSize() != numberOfLayers))
+    throw InvalidArgumentException(HERE) << "Error: got " << numberOfLayers << " weight matrices, " << bias.getSize() << " bias vectors and " << activations.getSize() << " activation functions";
+  if (p_network_->layerSizes_[0] == 0)
+    throw InvalidArgumentException(HERE) << "Error: a neural network must have at least one input";
+  if (inputScale.getDimension() != p_network_->layerSizes_[0])
+    throw InvalidArgumentException(HERE) << "Error: input scale has dimension " << inputScale.getDimension() << ", expected " << p_network_->layerSizes_[0];
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    if (weights[layer].getNbRows() != p_network_->layerSizes_[layer])
+      throw InvalidArgumentException(HERE) << "Error: weights of layer " << layer << " have " << weights[layer].getNbRows() << " rows, expected " << p_network_->layerSizes_[layer];
+    const UnsignedInteger width = weights[layer].getNbColumns();
+    if (width == 0)
+      throw InvalidArgumentException(HERE) << "Error: layer " << layer << " has no neuron";
+    if (bias[layer].getDimension() != width)
+      throw InvalidArgumentException(HERE) << "Error: bias of layer " << layer << " has dimension " << bias[layer].getDimension() << ", expected " << width;
+    p_network_->layerSizes_.add(width);
+  }
+  const UnsignedInteger outputDimension = p_network_->layerSizes_[numberOfLayers];
+  if ((outputScale.getDimension() != outputDimension) || (outputShift.getDimension() != outputDimension))
+    throw InvalidArgumentException(HERE) << "Error: output denormalization has dimension " << outputScale.getDimension() << ", expected " << outputDimension;
+  if ((neuralInputNames.getSize() != 0) && (neuralInputNames.getSize() != p_network_->layerSizes_[0]))
+    throw InvalidArgumentException(HERE) << "Error: got " << neuralInputNames.getSize() << " neural input names, expected " << p_network_->layerSizes_[0];
+  if ((neuralOutputNames.getSize() != 0) && (neuralOutputNames.getSize() != outputDimension))
+    throw InvalidArgumentException(HERE) << "Error: got " << neuralOutputNames.getSize() << " neural output names, expected " << outputDimension;
+  p_network_->neuralInputNames_ = neuralInputNames;
+  p_network_->neuralOutputNames_ = neuralOutputNames;
+
+  // Store weights of each neuron contiguously, so that each neuron is a dot product;
+  // layers with few connections only store their non zero weights (CSR format)
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    const Matrix & matrix = weights[layer];
+    UnsignedInteger connections = 0;
+    for (UnsignedInteger i = 0; i < matrix.getNbColumns(); ++i)
+      for (UnsignedInteger k = 0; k < matrix.getNbRows(); ++k)
+        if (matrix(k, i) != 0.0) ++connections;
+    const Bool sparse = connections <= NeuralNetworkEvaluationSparseDensity * matrix.getNbRows() * matrix.getNbColumns();
+    p_network_->sparseLayers_.add(sparse ? 1 : 0);
+    for (UnsignedInteger i = 0; i < matrix.getNbColumns(); ++i)
+    {
+      if (sparse)
+      {
+        p_network_->sparseRows_.add(p_network_->sparseWeights_.getSize());
+        for (UnsignedInteger k = 0; k < matrix.getNbRows(); ++k)
+          if (matrix(k, i) != 0.0)
+          {
+            p_network_->sparseWeights_.add(matrix(k, i));
+            p_network_->sparseColumns_.add(k);
+          }
+      }
+      else
+        for (UnsignedInteger k = 0; k < matrix.getNbRows(); ++k)
+          p_network_->weights_.add(matrix(k, i));
+      p_network_->bias_.add(bias[layer][i]);
+    }
+    if (sparse)
+      p_network_->sparseRows_.add(p_network_->sparseWeights_.getSize());
+  }
+  computeOffsets();
+  setInputDescription(Description::BuildDefault(p_network_->layerSizes_[0], "x"));
+  setOutputDescription(Description::BuildDefault(outputDimension, "y"));
+}
+
+/* Virtual constructor */
+NeuralNetworkEvaluation * NeuralNetworkEvaluation::clone() const
+{
+  return new NeuralNetworkEvaluation(*this);
+}
+
+/* Compute offsets of each layer into weights_ (or sparseRows_) and bias_ */
+void NeuralNetworkEvaluation::computeOffsets()
+{
+  const UnsignedInteger numberOfLayers = getNumberOfLayers();
+  p_network_->weightsOffsets_ = Indices(numberOfLayers);
+  p_network_->biasOffsets_ = Indices(numberOfLayers);
+  p_network_->maximumWidth_ = p_network_->layerSizes_[0];
+  UnsignedInteger weightsOffset = 0;
+  UnsignedInteger sparseRowsOffset = 0;
+  UnsignedInteger biasOffset = 0;
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    if (p_network_->sparseLayers_[layer])
+    {
+      p_network_->weightsOffsets_[layer] = sparseRowsOffset;
+      sparseRowsOffset += p_network_->layerSizes_[layer + 1] + 1;
+    }
+    else
+    {
+      p_network_->weightsOffsets_[layer] = weightsOffset;
+      weightsOffset += p_network_->layerSizes_[layer] * p_network_->layerSizes_[layer + 1];
+    }
+    p_network_->biasOffsets_[layer] = biasOffset;
+    biasOffset += p_network_->layerSizes_[layer + 1];
+    p_network_->maximumWidth_ = std::max(p_network_->maximumWidth_, p_network_->layerSizes_[layer + 1]);
+  }
+  p_network_->identityInputsNormalization_ = true;
+  for (UnsignedInteger j = 0; j < p_network_->inputCenter_.getDimension(); ++j)
+    p_network_->identityInputsNormalization_ = p_network_->identityInputsNormalization_ && (p_network_->inputCenter_[j] == 0.0) && (p_network_->inputScale_[j] == 1.0);
+}
+
+/* Build the single precision copies of the weights and biases; NATIVE networks never pay for them */
+void NeuralNetworkEvaluation::computeSinglePrecisionCopies() const
+{
+  Network & network = *p_network_;
+  std::call_once(network.singlePrecisionOnce_, [&network]()
+  {
+    network.singlePrecisionWeights_.assign(network.weights_.begin(), network.weights_.end());
+    network.singlePrecisionSparseWeights_.assign(network.sparseWeights_.begin(), network.sparseWeights_.end());
+    network.singlePrecisionBias_.assign(network.bias_.begin(), network.bias_.end());
+    network.singlePrecisionCopies_ = true;
+  });
+}
+
+/* Normalize a block of contiguous points */
+void NeuralNetworkEvaluation::normalizeInputs(const Scalar * inP, const UnsignedInteger size, Scalar * normalized) const
+{
+  const UnsignedInteger inputDimension = p_network_->layerSizes_[0];
+  for (UnsignedInteger p = 0; p < size; ++p)
+    for (UnsignedInteger j = 0; j < inputDimension; ++j)
+      normalized[p * inputDimension + j] = (inP[p * inputDimension + j] - p_network_->inputCenter_[j]) * p_network_->inputScale_[j];
+}
+
+/* Apply weights of a layer z = W.a to a block of contiguous vectors */
+void NeuralNetworkEvaluation::applyWeights(const UnsignedInteger layerIndex, const Scalar * a, const UnsignedInteger size, Scalar * z) const
+{
+  const UnsignedInteger fanIn = p_network_->layerSizes_[layerIndex];
+  const UnsignedInteger width = p_network_->layerSizes_[layerIndex + 1];
+  if (p_network_->sparseLayers_[layerIndex])
+  {
+    const UnsignedInteger * rows = &p_network_->sparseRows_[p_network_->weightsOffsets_[layerIndex]];
+    for (UnsignedInteger p = 0; p < size; ++p)
+    {
+      const Scalar * ap = a + p * fanIn;
+      Scalar * zp = z + p * width;
+      for (UnsignedInteger i = 0; i < width; ++i)
+      {
+        Scalar sum = 0.0;
+        for (UnsignedInteger j = rows[i]; j < rows[i + 1]; ++j)
+          sum += p_network_->sparseWeights_[j] * ap[p_network_->sparseColumns_[j]];
+        zp[i] = sum;
+      }
+    }
+    return;
+  }
+  const Scalar * weights = &p_network_->weights_[p_network_->weightsOffsets_[layerIndex]];
+  for (UnsignedInteger p = 0; p < size; ++p)
+  {
+    const Scalar * ap = a + p * fanIn;
+    Scalar * zp = z + p * width;
+    for (UnsignedInteger i = 0; i < width; ++i)
+    {
+      const Scalar * w = weights + i * fanIn;
+      Scalar sum = 0.0;
+      for (UnsignedInteger k = 0; k < fanIn; ++k)
+        sum += w[k] * ap[k];
+      zp[i] = sum;
+    }
+  }
+}
+
+/* Compute pre-activations z = W.a + b of a layer for a block of contiguous points */
+void NeuralNetworkEvaluation::computeLayer(const UnsignedInteger layerIndex, const Scalar * a, const UnsignedInteger size, Scalar * z) const
+{
+  applyWeights(layerIndex, a, size, z);
+  const UnsignedInteger width = p_network_->layerSizes_[layerIndex + 1];
+  const Scalar * bias = &p_network_->bias_[p_network_->biasOffsets_[layerIndex]];
+  for (UnsignedInteger p = 0; p < size; ++p)
+    for (UnsignedInteger i = 0; i < width; ++i)
+      z[p * width + i] += bias[i];
+}
+
+/* Propagate adjoints of pre-activations to the previous layer: previous = adjoint.W */
+void NeuralNetworkEvaluation::backpropagateLayer(const UnsignedInteger layerIndex, const Scalar * adjoint, const UnsignedInteger rows, Scalar * previous) const
+{
+  const UnsignedInteger fanIn = p_network_->layerSizes_[layerIndex];
+  const UnsignedInteger width = p_network_->layerSizes_[layerIndex + 1];
+  std::fill(previous, previous + rows * fanIn, 0.0);
+  if (p_network_->sparseLayers_[layerIndex])
+  {
+    const UnsignedInteger * sparseRows = &p_network_->sparseRows_[p_network_->weightsOffsets_[layerIndex]];
+    for (UnsignedInteger r = 0; r < rows; ++r)
+    {
+      Scalar * previousRow = previous + r * fanIn;
+      for (UnsignedInteger i = 0; i < width; ++i)
+      {
+        const Scalar factor = adjoint[r * width + i];
+        if (factor == 0.0) continue;
+        for (UnsignedInteger j = sparseRows[i]; j < sparseRows[i + 1]; ++j)
+          previousRow[p_network_->sparseColumns_[j]] += factor * p_network_->sparseWeights_[j];
+      }
+    }
+    return;
+  }
+  const Scalar * weights = &p_network_->weights_[p_network_->weightsOffsets_[layerIndex]];
+  for (UnsignedInteger r = 0; r < rows; ++r)
+  {
+    Scalar * previousRow = previous + r * fanIn;
+    for (UnsignedInteger i = 0; i < width; ++i)
+    {
+      const Scalar factor = adjoint[r * width + i];
+      if (factor == 0.0) continue;
+      const Scalar * w = weights + i * fanIn;
+      for (UnsignedInteger k = 0; k < fanIn; ++k)
+        previousRow[k] += factor * w[k];
+    }
+  }
+}
+
+/* Evaluate a block of contiguous points */
+void NeuralNetworkEvaluation::evaluateBlock(const Scalar * inP, const UnsignedInteger size, Scalar * outP, Scalar * work) const
+{
+  const UnsignedInteger numberOfLayers = getNumberOfLayers();
+  Scalar * current = work;
+  Scalar * next = work + size * p_network_->maximumWidth_;
+
+  // When the normalization has been folded into the first layer, it reads inputs directly
+  const Scalar * layerInput = inP;
+  if (!p_network_->identityInputsNormalization_)
+  {
+    normalizeInputs(inP, size, current);
+    layerInput = current;
+  }
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    computeLayer(layer, layerInput, size, next);
+    Activation::Evaluate(p_network_->activations_[layer], next, size * p_network_->layerSizes_[layer + 1]);
+    layerInput = next;
+    std::swap(current, next);
+  }
+
+  const UnsignedInteger outputDimension = p_network_->layerSizes_[numberOfLayers];
+  for (UnsignedInteger p = 0; p < size; ++p)
+    for (UnsignedInteger j = 0; j < outputDimension; ++j)
+      outP[p * outputDimension + j] = layerInput[p * outputDimension + j] * p_network_->outputScale_[j] + p_network_->outputShift_[j];
+}
+
+/* Compute pre-activations z = W.a + b of a layer in single precision */
+void NeuralNetworkEvaluation::computeLayerSinglePrecision(const UnsignedInteger layerIndex, const float * a, const UnsignedInteger size, float * z) const
+{
+  const UnsignedInteger fanIn = p_network_->layerSizes_[layerIndex];
+  const UnsignedInteger width = p_network_->layerSizes_[layerIndex + 1];
+  const float * bias = &p_network_->singlePrecisionBias_[p_network_->biasOffsets_[layerIndex]];
+  if (p_network_->sparseLayers_[layerIndex])
+  {
+    const UnsignedInteger * rows = &p_network_->sparseRows_[p_network_->weightsOffsets_[layerIndex]];
+    for (UnsignedInteger p = 0; p < size; ++p)
+    {
+      const float * ap = a + p * fanIn;
+      float * zp = z + p * width;
+      for (UnsignedInteger i = 0; i < width; ++i)
+      {
+        float sum = 0.0f;
+        for (UnsignedInteger j = rows[i]; j < rows[i + 1]; ++j)
+          sum += p_network_->singlePrecisionSparseWeights_[j] * ap[p_network_->sparseColumns_[j]];
+        zp[i] = sum + bias[i];
+      }
+    }
+    return;
+  }
+  const float * weights = &p_network_->singlePrecisionWeights_[p_network_->weightsOffsets_[layerIndex]];
+  for (UnsignedInteger p = 0; p < size; ++p)
+  {
+    const float * ap = a + p * fanIn;
+    float * zp = z + p * width;
+    for (UnsignedInteger i = 0; i < width; ++i)
+    {
+      const float * w = weights + i * fanIn;
+      float sum = 0.0f;
+      for (UnsignedInteger k = 0; k < fanIn; ++k)
+        sum += w[k] * ap[k];
+      zp[i] = sum + bias[i];
+    }
+  }
+}
+
+/* Evaluate a block of contiguous points in single precision */
+void NeuralNetworkEvaluation::evaluateBlockSinglePrecision(const Scalar * inP, const UnsignedInteger size, Scalar * outP, float * work) const
+{
+  const UnsignedInteger numberOfLayers = getNumberOfLayers();
+  float * current = work;
+  float * next = work + size * p_network_->maximumWidth_;
+
+  // Normalization is done in double precision, inputs may be far from the origin
+  const UnsignedInteger inputDimension = p_network_->layerSizes_[0];
+  for (UnsignedInteger p = 0; p < size; ++p)
+    for (UnsignedInteger j = 0; j < inputDimension; ++j)
+      current[p * inputDimension + j] = static_cast<float>((inP[p * inputDimension + j] - p_network_->inputCenter_[j]) * p_network_->inputScale_[j]);
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    computeLayerSinglePrecision(layer, current, size, next);
+    Activation::Evaluate(p_network_->activations_[layer], next, size * p_network_->layerSizes_[layer + 1]);
+    std::swap(current, next);
+  }
+
+  const UnsignedInteger outputDimension = p_network_->layerSizes_[numberOfLayers];
+  for (UnsignedInteger p = 0; p < size; ++p)
+    for (UnsignedInteger j = 0; j < outputDimension; ++j)
+      outP[p * outputDimension + j] = current[p * outputDimension + j] * p_network_->outputScale_[j] + p_network_->outputShift_[j];
+}
+
+/* Operator () */
+Point NeuralNetworkEvaluation::operator() (const Point & inP) const
+{
+  const UnsignedInteger inputDimension = getInputDimension();
+  if (inP.getDimension() != inputDimension)
+    throw InvalidArgumentException(HERE) << "Error: trying to evaluate a NeuralNetworkEvaluation with an argument of invalid dimension, expected " << inputDimension << ", got " << inP.getDimension();
+  Point outP(getOutputDimension());
+  if (singlePrecision_)
+  {
+    computeSinglePrecisionCopies();
+    std::vector<float> work(2 * p_network_->maximumWidth_);
+    evaluateBlockSinglePrecision(&inP[0], 1, &outP[0], &work[0]);
+  }
+  else
+  {
+    std::vector<Scalar> work(2 * p_network_->maximumWidth_);
+    evaluateBlock(&inP[0], 1, &outP[0], &work[0]);
+  }
+  callsNumber_.increment();
+  return outP;
+}
+
+/* Evaluate blocks [from, to) of a sample, each block writing its own rows */
+struct NeuralNetworkEvaluationPolicy
+{
+  const NeuralNetworkEvaluation & evaluation_;
+  const Scalar * input_;
+  Scalar * output_;
+  const UnsignedInteger size_;
+  const UnsignedInteger blockSize_;
+  const Bool singlePrecision_;
+
+  NeuralNetworkEvaluationPolicy(const NeuralNetworkEvaluation & evaluation,
+                                const Scalar * input,
+                                Scalar * output,
+                                const UnsignedInteger size,
+                                const UnsignedInteger blockSize,
+                                const Bool singlePrecision)
+    : evaluation_(evaluation)
+    , input_(input)
+    , output_(output)
+    , size_(size)
+    , blockSize_(blockSize)
+    , singlePrecision_(singlePrecision)
+  {}
+
+  void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    const UnsignedInteger inputDimension = evaluation_.getInputDimension();
+    const UnsignedInteger outputDimension = evaluation_.getOutputDimension();
+    const UnsignedInteger workSize = 2 * blockSize_ * evaluation_.p_network_->maximumWidth_;
+    std::vector<Scalar> work(singlePrecision_ ? 0 : workSize);
+    std::vector<float> singlePrecisionWork(singlePrecision_ ? workSize : 0);
+    for (UnsignedInteger block = r.begin(); block != r.end(); ++block)
+    {
+      const UnsignedInteger start = block * blockSize_;
+      const UnsignedInteger length = std::min(blockSize_, size_ - start);
+      if (singlePrecision_)
+        evaluation_.evaluateBlockSinglePrecision(input_ + start * inputDimension, length, output_ + start * outputDimension, &singlePrecisionWork[0]);
+      else
+        evaluation_.evaluateBlock(input_ + start * inputDimension, length, output_ + start * outputDimension, &work[0]);
+    }
+  }
+}; /* end struct NeuralNetworkEvaluationPolicy */
+
+/* Evaluate a sample of valid dimension into outS */
+void NeuralNetworkEvaluation::evaluateSample(const Sample & inS, const Bool singlePrecision, Sample & outS) const
+{
+  const UnsignedInteger size = inS.getSize();
+  if (size > 0)
+  {
+    if (singlePrecision)
+      computeSinglePrecisionCopies();
+    const UnsignedInteger blockSize = std::min(size, blockSize_);
+    const UnsignedInteger numberOfBlocks = (size + blockSize - 1) / blockSize;
+    const NeuralNetworkEvaluationPolicy policy(*this, &inS(0, 0), &outS(0, 0), size, blockSize, singlePrecision);
+    // Blocks write disjoint rows and points are evaluated independently, so the
+    // result does not depend on the number of threads nor on the scheduling
+    UnsignedInteger numberOfThreads = numberOfThreads_;
+    if ((numberOfThreads == 0) && !TBBImplementation::IsAvailable())
+      numberOfThreads = GetNumberOfThreads(0);
+    numberOfThreads = std::min(numberOfThreads, numberOfBlocks);
+    if (numberOfThreads == 0)
+      TBBImplementation::ParallelFor(0, numberOfBlocks, policy);
+    else if (numberOfThreads == 1)
+      policy(TBBImplementation::BlockedRange<UnsignedInteger>(0, numberOfBlocks));
+    else
+      RunTasks(numberOfBlocks, numberOfThreads, [&policy](const UnsignedInteger block)
+      {
+        policy(TBBImplementation::BlockedRange<UnsignedInteger>(block, block + 1));
+      });
+  }
+}
+
+Sample NeuralNetworkEvaluation::operator() (const Sample & inS) const
+{
+  const UnsignedInteger inputDimension = getInputDimension();
+  if (inS.getDimension() != inputDimension)
+    throw InvalidArgumentException(HERE) << "Error: the given sample has an invalid dimension, expected " << inputDimension << ", got " << inS.getDimension();
+  const UnsignedInteger size = inS.getSize();
+  Sample outS(size, getOutputDimension());
+  evaluateSample(inS, singlePrecision_, outS);
+  callsNumber_.fetchAndAdd(size);
+  outS.setDescription(getOutputDescription());
+  return outS;
+}
+
+/* Block size accessor */
+void NeuralNetworkEvaluation::setBlockSize(const UnsignedInteger blockSize)
+{
+  if (blockSize == 0)
+    throw InvalidArgumentException(HERE) << "Error: the block size must be positive";
+  blockSize_ = blockSize;
+}
+
+UnsignedInteger NeuralNetworkEvaluation::getBlockSize() const
+{
+  return blockSize_;
+}
+
+/* Number of threads accessor */
+void NeuralNetworkEvaluation::setNumberOfThreads(const UnsignedInteger numberOfThreads)
+{
+  numberOfThreads_ = numberOfThreads;
+}
+
+UnsignedInteger NeuralNetworkEvaluation::getNumberOfThreads() const
+{
+  return numberOfThreads_;
+}
+
+/* Single precision accessor */
+void NeuralNetworkEvaluation::setSinglePrecision(const Bool singlePrecision)
+{
+  singlePrecision_ = singlePrecision;
+  if (singlePrecision_)
+    computeSinglePrecisionCopies();
+}
+
+Bool NeuralNetworkEvaluation::isSinglePrecision() const
+{
+  return singlePrecision_;
+}
+
+/* Maximum absolute deviation of each output between single and double precision evaluations of a sample */
+Point NeuralNetworkEvaluation::computeSinglePrecisionDeviation(const Sample & inS) const
+{
+  const UnsignedInteger inputDimension = getInputDimension();
+  if (inS.getDimension() != inputDimension)
+    throw InvalidArgumentException(HERE) << "Error: the given sample has an invalid dimension, expected " << inputDimension << ", got " << inS.getDimension();
+  const UnsignedInteger size = inS.getSize();
+  const UnsignedInteger outputDimension = getOutputDimension();
+  Sample doubleOutput(size, outputDimension);
+  evaluateSample(inS, false, doubleOutput);
+  Sample singleOutput(size, outputDimension);
+  evaluateSample(inS, true, singleOutput);
+  Point deviation(outputDimension);
+  for (UnsignedInteger i = 0; i < size; ++i)
+    for (UnsignedInteger j = 0; j < outputDimension; ++j)
+      deviation[j] = std::max(deviation[j], std::abs(singleOutput(i, j) - doubleOutput(i, j)));
+  return deviation;
+}
+
+/* Accessor for input point dimension */
+UnsignedInteger NeuralNetworkEvaluation::getInputDimension() const
+{
+  return p_network_->layerSizes_[0];
+}
+
+/* Accessor for output point dimension */
+UnsignedInteger NeuralNetworkEvaluation::getOutputDimension() const
+{
+  return p_network_->layerSizes_[p_network_->layerSizes_.getSize() - 1];
+}
+
+/* Number of layers accessor */
+UnsignedInteger NeuralNetworkEvaluation::getNumberOfLayers() const
+{
+  return p_network_->layerSizes_.getSize() - 1;
+}
+
+/* Layer size accessor */
+UnsignedInteger NeuralNetworkEvaluation::getLayerSize(const UnsignedInteger layerIndex) const
+{
+  if (layerIndex >= getNumberOfLayers())
+    throw InvalidArgumentException(HERE) << "Error: layer index " << layerIndex << " must be less than " << getNumberOfLayers();
+  return p_network_->layerSizes_[layerIndex + 1];
+}
+
+/* Whether a layer is stored as a sparse matrix */
+Bool NeuralNetworkEvaluation::isSparseLayer(const UnsignedInteger layerIndex) const
+{
+  if (layerIndex >= getNumberOfLayers())
+    throw InvalidArgumentException(HERE) << "Error: layer index " << layerIndex << " must be less than " << getNumberOfLayers();
+  return p_network_->sparseLayers_[layerIndex] != 0;
+}
+
+/* Activation function accessor */
+UnsignedInteger NeuralNetworkEvaluation::getActivationAtLayer(const UnsignedInteger layerIndex) const
+{
+  if (layerIndex >= getNumberOfLayers())
+    throw InvalidArgumentException(HERE) << "Error: layer index " << layerIndex << " must be less than " << getNumberOfLayers();
+  return p_network_->activations_[layerIndex];
+}
+
+/* Neural fields accessors */
+Description NeuralNetworkEvaluation::getNeuralInputNames() const
+{
+  return p_network_->neuralInputNames_;
+}
+
+Description NeuralNetworkEvaluation::getNeuralOutputNames() const
+{
+  return p_network_->neuralOutputNames_;
+}
+
+/* Approximate memory used by the compiled network, in bytes */
+UnsignedInteger NeuralNetworkEvaluation::getMemoryUsage() const
+{
+  const Network & network = *p_network_;
+  const UnsignedInteger numberOfScalars = network.weights_.getDimension() + network.sparseWeights_.getDimension() + network.bias_.getDimension()
+                                          + network.inputCenter_.getDimension() + network.inputScale_.getDimension()
+                                          + network.outputScale_.getDimension() + network.outputShift_.getDimension();
+  const UnsignedInteger numberOfIndices = network.layerSizes_.getSize() + network.activations_.getSize() + network.sparseLayers_.getSize()
+                                          + network.sparseColumns_.getSize() + network.sparseRows_.getSize()
+                                          + network.weightsOffsets_.getSize() + network.biasOffsets_.getSize();
+  // Single precision copies only count once they have been built
+  const UnsignedInteger numberOfFloats = !network.singlePrecisionCopies_ ? 0 : network.singlePrecisionWeights_.size() + network.singlePrecisionSparseWeights_.size() + network.singlePrecisionBias_.size();
+  return sizeof(Network) + numberOfScalars * sizeof(Scalar) + numberOfIndices * sizeof(UnsignedInteger) + numberOfFloats * sizeof(float);
+}
+
+/* String converter */
+String NeuralNetworkEvaluation::__repr__() const
+{
+  return OSS(true) << "class=" << NeuralNetworkEvaluation::GetClassName()
+         << " name=" << getName()
+         << " layerSizes=" << p_network_->layerSizes_
+         << " activations=" << p_network_->activations_
+         << " inputCenter=" << p_network_->inputCenter_
+         << " inputScale=" << p_network_->inputScale_
+         << " weights=" << p_network_->weights_
+         << " sparseLayers=" << p_network_->sparseLayers_
+         << " sparseWeights=" << p_network_->sparseWeights_
+         << " sparseColumns=" << p_network_->sparseColumns_
+         << " sparseRows=" << p_network_->sparseRows_
+         << " bias=" << p_network_->bias_
+         << " outputScale=" << p_network_->outputScale_
+         << " outputShift=" << p_network_->outputShift_
+         << " neuralInputNames=" << p_network_->neuralInputNames_
+         << " neuralOutputNames=" << p_network_->neuralOutputNames_
+         << " singlePrecision=" << singlePrecision_;
+}
+
+String NeuralNetworkEvaluation::__str__(const String & offset) const
+{
+  OSS oss(false);
+  oss << offset << getClassName() << " : " << p_network_->layerSizes_[0] << " inputs";
+  for (UnsignedInteger layer = 0; layer < getNumberOfLayers(); ++layer)
+    oss << " -> " << p_network_->layerSizes_[layer + 1] << " (" << Activation::GetName(p_network_->activations_[layer]) << (p_network_->sparseLayers_[layer] ? ", sparse" : "") << ")";
+  if (singlePrecision_)
+    oss << ", single precision";
+  return oss;
+}
+
+/* Method save() stores the object through the StorageManager */
+void NeuralNetworkEvaluation::save(Advocate & adv) const
+{
+  EvaluationImplementation::save(adv);
+  adv.saveAttribute("layerSizes_", p_network_->layerSizes_);
+  adv.saveAttribute("activations_", p_network_->activations_);
+  adv.saveAttribute("weights_", p_network_->weights_);
+  adv.saveAttribute("sparseLayers_", p_network_->sparseLayers_);
+  adv.saveAttribute("sparseWeights_", p_network_->sparseWeights_);
+  adv.saveAttribute("sparseColumns_", p_network_->sparseColumns_);
+  adv.saveAttribute("sparseRows_", p_network_->sparseRows_);
+  adv.saveAttribute("bias_", p_network_->bias_);
+  adv.saveAttribute("inputCenter_", p_network_->inputCenter_);
+  adv.saveAttribute("inputScale_", p_network_->inputScale_);
+  adv.saveAttribute("outputScale_", p_network_->outputScale_);
+  adv.saveAttribute("outputShift_", p_network_->outputShift_);
+  adv.saveAttribute("neuralInputNames_", p_network_->neuralInputNames_);
+  adv.saveAttribute("neuralOutputNames_", p_network_->neuralOutputNames_);
+  adv.saveAttribute("blockSize_", blockSize_);
+  adv.saveAttribute("numberOfThreads_", numberOfThreads_);
+  adv.saveAttribute("singlePrecision_", singlePrecision_);
+}
+
+/* Method load() reloads the object from the StorageManager */
+void NeuralNetworkEvaluation::load(Advocate & adv)
+{
+  EvaluationImplementation::load(adv);
+  // The network may be shared with other evaluations
+  p_network_ = new Network;
+  adv.loadAttribute("layerSizes_", p_network_->layerSizes_);
+  adv.loadAttribute("activations_", p_network_->activations_);
+  adv.loadAttribute("weights_", p_network_->weights_);
+  adv.loadAttribute("sparseLayers_", p_network_->sparseLayers_);
+  adv.loadAttribute("sparseWeights_", p_network_->sparseWeights_);
+  adv.loadAttribute("sparseColumns_", p_network_->sparseColumns_);
+  adv.loadAttribute("sparseRows_", p_network_->sparseRows_);
+  adv.loadAttribute("bias_", p_network_->bias_);
+  adv.loadAttribute("inputCenter_", p_network_->inputCenter_);
+  adv.loadAttribute("inputScale_", p_network_->inputScale_);
+  adv.loadAttribute("outputScale_", p_network_->outputScale_);
+  adv.loadAttribute("outputShift_", p_network_->outputShift_);
+  adv.loadAttribute("neuralInputNames_", p_network_->neuralInputNames_);
+  adv.loadAttribute("neuralOutputNames_", p_network_->neuralOutputNames_);
+  adv.loadAttribute("blockSize_", blockSize_);
+  adv.loadAttribute("numberOfThreads_", numberOfThreads_);
+  adv.loadAttribute("singlePrecision_", singlePrecision_);
+  computeOffsets();
+}
+
+} /* namespace OTPMML */
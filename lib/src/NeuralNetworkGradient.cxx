@@ -0,0 +1,158 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkGradient.cxx
+ *  @brief Analytical gradient of a feed-forward neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/NeuralNetworkGradient.hxx"
+#include "otpmml/Activation.hxx"
+
+#include <openturns/PersistentObjectFactory.hxx>
+#include <openturns/Exception.hxx>
+
+#include <algorithm>
+#include <vector>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(NeuralNetworkGradient)
+
+static const Factory<NeuralNetworkGradient> Factory_NeuralNetworkGradient;
+
+/* Default constructor */
+NeuralNetworkGradient::NeuralNetworkGradient()
+  : GradientImplementation()
+  , p_evaluation_(new NeuralNetworkEvaluation)
+{
+  // Nothing to do
+}
+
+/* Parameters constructor */
+NeuralNetworkGradient::NeuralNetworkGradient(const NeuralNetworkEvaluationPointer & p_evaluation)
+  : GradientImplementation()
+  , p_evaluation_(p_evaluation)
+{
+  // Nothing to do
+}
+
+/* Virtual constructor */
+NeuralNetworkGradient * NeuralNetworkGradient::clone() const
+{
+  return new NeuralNetworkGradient(*this);
+}
+
+/* Gradient method */
+Matrix NeuralNetworkGradient::gradient(const Point & inP) const
+{
+  const NeuralNetworkEvaluation & evaluation = *p_evaluation_;
+  const UnsignedInteger inputDimension = getInputDimension();
+  if (inP.getDimension() != inputDimension)
+    throw InvalidArgumentException(HERE) << "Error: trying to compute the gradient of a NeuralNetworkGradient with an argument of invalid dimension, expected " << inputDimension << ", got " << inP.getDimension();
+  const UnsignedInteger outputDimension = getOutputDimension();
+  const UnsignedInteger numberOfLayers = evaluation.getNumberOfLayers();
+  const Indices & layerSizes = evaluation.p_network_->layerSizes_;
+  const UnsignedInteger maximumWidth = evaluation.p_network_->maximumWidth_;
+
+  // Forward pass, keeping the derivative of the activation function of every neuron
+  std::vector<Scalar> derivatives(evaluation.p_network_->bias_.getDimension());
+  std::vector<Scalar> current(maximumWidth);
+  std::vector<Scalar> next(maximumWidth);
+  evaluation.normalizeInputs(&inP[0], 1, &current[0]);
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    const UnsignedInteger width = layerSizes[layer + 1];
+    const UnsignedInteger activation = evaluation.p_network_->activations_[layer];
+    Scalar * layerDerivatives = &derivatives[evaluation.p_network_->biasOffsets_[layer]];
+    evaluation.computeLayer(layer, &current[0], 1, &next[0]);
+    for (UnsignedInteger i = 0; i < width; ++i)
+      layerDerivatives[i] = Activation::Derivative(activation, next[i]);
+    Activation::Evaluate(activation, &next[0], width);
+    current.swap(next);
+  }
+
+  // Reverse pass: one adjoint row per output, seeded by the output denormalization
+  std::vector<Scalar> adjoint(outputDimension * maximumWidth);
+  std::vector<Scalar> previous(outputDimension * maximumWidth);
+  for (UnsignedInteger j = 0; j < outputDimension; ++j)
+    adjoint[j * outputDimension + j] = evaluation.p_network_->outputScale_[j];
+  for (UnsignedInteger layer = numberOfLayers; layer > 0; --layer)
+  {
+    const UnsignedInteger width = layerSizes[layer];
+    const Scalar * layerDerivatives = &derivatives[evaluation.p_network_->biasOffsets_[layer - 1]];
+    for (UnsignedInteger j = 0; j < outputDimension; ++j)
+      for (UnsignedInteger i = 0; i < width; ++i)
+        adjoint[j * width + i] *= layerDerivatives[i];
+    evaluation.backpropagateLayer(layer - 1, &adjoint[0], outputDimension, &previous[0]);
+    adjoint.swap(previous);
+  }
+
+  // Input normalization, gradient is stored as (input, output)
+  Matrix result(inputDimension, outputDimension);
+  for (UnsignedInteger j = 0; j < outputDimension; ++j)
+    for (UnsignedInteger k = 0; k < inputDimension; ++k)
+      result(k, j) = adjoint[j * inputDimension + k] * evaluation.p_network_->inputScale_[k];
+  callsNumber_.increment();
+  return result;
+}
+
+/* Accessor for input point dimension */
+UnsignedInteger NeuralNetworkGradient::getInputDimension() const
+{
+  return p_evaluation_->getInputDimension();
+}
+
+/* Accessor for output point dimension */
+UnsignedInteger NeuralNetworkGradient::getOutputDimension() const
+{
+  return p_evaluation_->getOutputDimension();
+}
+
+/* String converter */
+String NeuralNetworkGradient::__repr__() const
+{
+  return OSS(true) << "class=" << NeuralNetworkGradient::GetClassName()
+         << " name=" << getName()
+         << " evaluation=" << p_evaluation_->__repr__();
+}
+
+String NeuralNetworkGradient::__str__(const String & offset) const
+{
+  return OSS(false) << offset << getClassName() << " of " << p_evaluation_->__str__();
+}
+
+/* Method save() stores the object through the StorageManager */
+void NeuralNetworkGradient::save(Advocate & adv) const
+{
+  GradientImplementation::save(adv);
+  adv.saveAttribute("evaluation_", *p_evaluation_);
+}
+
+/* Method load() reloads the object from the StorageManager */
+void NeuralNetworkGradient::load(Advocate & adv)
+{
+  GradientImplementation::load(adv);
+  NeuralNetworkEvaluation evaluation;
+  adv.loadAttribute("evaluation_", evaluation);
+  p_evaluation_ = NeuralNetworkEvaluationPointer(evaluation.clone());
+}
+
+} /* namespace OTPMML */
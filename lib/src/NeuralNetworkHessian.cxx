@@ -0,0 +1,234 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkHessian.cxx
+ *  @brief Analytical hessian of a feed-forward neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/NeuralNetworkHessian.hxx"
+#include "otpmml/Activation.hxx"
+
+#include <openturns/PersistentObjectFactory.hxx>
+#include <openturns/Exception.hxx>
+
+#include <algorithm>
+#include <vector>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(NeuralNetworkHessian)
+
+static const Factory<NeuralNetworkHessian> Factory_NeuralNetworkHessian;
+
+/* Default constructor */
+NeuralNetworkHessian::NeuralNetworkHessian()
+  : HessianImplementation()
+  , p_evaluation_(new NeuralNetworkEvaluation)
+{
+  // Nothing to do
+}
+
+/* Parameters constructor */
+NeuralNetworkHessian::NeuralNetworkHessian(const NeuralNetworkEvaluationPointer & p_evaluation)
+  : HessianImplementation()
+  , p_evaluation_(p_evaluation)
+{
+  // Nothing to do
+}
+
+/* Virtual constructor */
+NeuralNetworkHessian * NeuralNetworkHessian::clone() const
+{
+  return new NeuralNetworkHessian(*this);
+}
+
+/* Workspace constructor */
+NeuralNetworkHessian::Workspace::Workspace(const NeuralNetworkEvaluation & evaluation)
+{
+  const UnsignedInteger inputDimension = evaluation.getInputDimension();
+  const UnsignedInteger outputDimension = evaluation.getOutputDimension();
+  const UnsignedInteger numberOfNeurons = evaluation.p_network_->bias_.getDimension();
+  const UnsignedInteger maximumWidth = evaluation.p_network_->maximumWidth_;
+  derivatives_.resize(numberOfNeurons);
+  secondDerivatives_.resize(numberOfNeurons);
+  tangents_.resize(inputDimension * numberOfNeurons);
+  current_.resize(maximumWidth);
+  next_.resize(maximumWidth);
+  currentTangent_.resize(inputDimension * maximumWidth);
+  nextTangent_.resize(inputDimension * maximumWidth);
+  adjoint_.resize(outputDimension * maximumWidth);
+  previousAdjoint_.resize(outputDimension * maximumWidth);
+  tangentAdjoint_.resize(outputDimension * inputDimension * maximumWidth);
+  previousTangentAdjoint_.resize(outputDimension * inputDimension * maximumWidth);
+}
+
+/* Compute the hessian at a point given by its components */
+void NeuralNetworkHessian::computeHessian(const Scalar * inP, Workspace & workspace, SymmetricTensor & result) const
+{
+  const NeuralNetworkEvaluation & evaluation = *p_evaluation_;
+  const UnsignedInteger inputDimension = evaluation.getInputDimension();
+  const UnsignedInteger outputDimension = evaluation.getOutputDimension();
+  const UnsignedInteger numberOfLayers = evaluation.getNumberOfLayers();
+  const Indices & layerSizes = evaluation.p_network_->layerSizes_;
+
+  // Forward pass: values, and tangents along each input direction, seeded by the input normalization
+  evaluation.normalizeInputs(inP, 1, &workspace.current_[0]);
+  std::fill(workspace.currentTangent_.begin(), workspace.currentTangent_.begin() + inputDimension * inputDimension, 0.0);
+  for (UnsignedInteger d = 0; d < inputDimension; ++d)
+    workspace.currentTangent_[d * inputDimension + d] = evaluation.p_network_->inputScale_[d];
+  for (UnsignedInteger layer = 0; layer < numberOfLayers; ++layer)
+  {
+    const UnsignedInteger width = layerSizes[layer + 1];
+    const UnsignedInteger activation = evaluation.p_network_->activations_[layer];
+    const UnsignedInteger offset = evaluation.p_network_->biasOffsets_[layer];
+    Scalar * derivatives = &workspace.derivatives_[offset];
+    Scalar * secondDerivatives = &workspace.secondDerivatives_[offset];
+    Scalar * tangents = &workspace.tangents_[inputDimension * offset];
+    evaluation.computeLayer(layer, &workspace.current_[0], 1, &workspace.next_[0]);
+    evaluation.applyWeights(layer, &workspace.currentTangent_[0], inputDimension, tangents);
+    for (UnsignedInteger i = 0; i < width; ++i)
+    {
+      derivatives[i] = Activation::Derivative(activation, workspace.next_[i]);
+      secondDerivatives[i] = Activation::SecondDerivative(activation, workspace.next_[i]);
+    }
+    for (UnsignedInteger d = 0; d < inputDimension; ++d)
+      for (UnsignedInteger i = 0; i < width; ++i)
+        workspace.nextTangent_[d * width + i] = derivatives[i] * tangents[d * width + i];
+    Activation::Evaluate(activation, &workspace.next_[0], width);
+    workspace.current_.swap(workspace.next_);
+    workspace.currentTangent_.swap(workspace.nextTangent_);
+  }
+
+  // Reverse pass: adjoints of all outputs, seeded by the output denormalization, and their tangents
+  const UnsignedInteger tangentRows = outputDimension * inputDimension;
+  std::fill(workspace.adjoint_.begin(), workspace.adjoint_.begin() + outputDimension * outputDimension, 0.0);
+  std::fill(workspace.tangentAdjoint_.begin(), workspace.tangentAdjoint_.begin() + tangentRows * outputDimension, 0.0);
+  for (UnsignedInteger j = 0; j < outputDimension; ++j)
+    workspace.adjoint_[j * outputDimension + j] = evaluation.p_network_->outputScale_[j];
+  for (UnsignedInteger layer = numberOfLayers; layer > 0; --layer)
+  {
+    const UnsignedInteger width = layerSizes[layer];
+    const UnsignedInteger offset = evaluation.p_network_->biasOffsets_[layer - 1];
+    const Scalar * derivatives = &workspace.derivatives_[offset];
+    const Scalar * secondDerivatives = &workspace.secondDerivatives_[offset];
+    const Scalar * tangents = &workspace.tangents_[inputDimension * offset];
+    for (UnsignedInteger j = 0; j < outputDimension; ++j)
+    {
+      Scalar * adjoint = &workspace.adjoint_[j * width];
+      for (UnsignedInteger d = 0; d < inputDimension; ++d)
+      {
+        Scalar * tangentAdjoint = &workspace.tangentAdjoint_[(j * inputDimension + d) * width];
+        for (UnsignedInteger i = 0; i < width; ++i)
+          tangentAdjoint[i] = tangentAdjoint[i] * derivatives[i] + adjoint[i] * secondDerivatives[i] * tangents[d * width + i];
+      }
+      for (UnsignedInteger i = 0; i < width; ++i)
+        adjoint[i] *= derivatives[i];
+    }
+    evaluation.backpropagateLayer(layer - 1, &workspace.adjoint_[0], outputDimension, &workspace.previousAdjoint_[0]);
+    evaluation.backpropagateLayer(layer - 1, &workspace.tangentAdjoint_[0], tangentRows, &workspace.previousTangentAdjoint_[0]);
+    workspace.adjoint_.swap(workspace.previousAdjoint_);
+    workspace.tangentAdjoint_.swap(workspace.previousTangentAdjoint_);
+  }
+
+  // Input normalization; the exact hessian is symmetric, average both halves against round-off
+  for (UnsignedInteger j = 0; j < outputDimension; ++j)
+  {
+    const Scalar * tangentAdjoint = &workspace.tangentAdjoint_[j * inputDimension * inputDimension];
+    for (UnsignedInteger k = 0; k < inputDimension; ++k)
+      for (UnsignedInteger d = 0; d <= k; ++d)
+      {
+        const Scalar value = 0.5 * (tangentAdjoint[d * inputDimension + k] * evaluation.p_network_->inputScale_[k] + tangentAdjoint[k * inputDimension + d] * evaluation.p_network_->inputScale_[d]);
+        result(k, d, j) = value;
+        result(d, k, j) = value;
+      }
+  }
+}
+
+/* Hessian method */
+SymmetricTensor NeuralNetworkHessian::hessian(const Point & inP) const
+{
+  const UnsignedInteger inputDimension = getInputDimension();
+  if (inP.getDimension() != inputDimension)
+    throw InvalidArgumentException(HERE) << "Error: trying to compute the hessian of a NeuralNetworkHessian with an argument of invalid dimension, expected " << inputDimension << ", got " << inP.getDimension();
+  Workspace workspace(*p_evaluation_);
+  SymmetricTensor result(inputDimension, getOutputDimension());
+  computeHessian(&inP[0], workspace, result);
+  callsNumber_.increment();
+  return result;
+}
+
+/* Hessian at each point of a sample */
+NeuralNetworkHessian::SymmetricTensorCollection NeuralNetworkHessian::hessian(const Sample & inS) const
+{
+  const UnsignedInteger inputDimension = getInputDimension();
+  if (inS.getDimension() != inputDimension)
+    throw InvalidArgumentException(HERE) << "Error: the given sample has an invalid dimension, expected " << inputDimension << ", got " << inS.getDimension();
+  const UnsignedInteger size = inS.getSize();
+  SymmetricTensorCollection result(size, SymmetricTensor(inputDimension, getOutputDimension()));
+  Workspace workspace(*p_evaluation_);
+  for (UnsignedInteger i = 0; i < size; ++i)
+    computeHessian(&inS(i, 0), workspace, result[i]);
+  callsNumber_.fetchAndAdd(size);
+  return result;
+}
+
+/* Accessor for input point dimension */
+UnsignedInteger NeuralNetworkHessian::getInputDimension() const
+{
+  return p_evaluation_->getInputDimension();
+}
+
+/* Accessor for output point dimension */
+UnsignedInteger NeuralNetworkHessian::getOutputDimension() const
+{
+  return p_evaluation_->getOutputDimension();
+}
+
+/* String converter */
+String NeuralNetworkHessian::__repr__() const
+{
+  return OSS(true) << "class=" << NeuralNetworkHessian::GetClassName()
+         << " name=" << getName()
+         << " evaluation=" << p_evaluation_->__repr__();
+}
+
+String NeuralNetworkHessian::__str__(const String & offset) const
+{
+  return OSS(false) << offset << getClassName() << " of " << p_evaluation_->__str__();
+}
+
+/* Method save() stores the object through the StorageManager */
+void NeuralNetworkHessian::save(Advocate & adv) const
+{
+  HessianImplementation::save(adv);
+  adv.saveAttribute("evaluation_", *p_evaluation_);
+}
+
+/* Method load() reloads the object from the StorageManager */
+void NeuralNetworkHessian::load(Advocate & adv)
+{
+  HessianImplementation::load(adv);
+  NeuralNetworkEvaluation evaluation;
+  adv.loadAttribute("evaluation_", evaluation);
+  p_evaluation_ = NeuralNetworkEvaluationPointer(evaluation.clone());
+}
+
+} /* namespace OTPMML */
@@ -0,0 +1,283 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NumberParsing.hxx
+ *  @brief Locale-independent conversion between text and numbers
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+// This file is not a regular header: it is only included by the sources which
+// read numbers from PMML attributes or from .dat files, or write .dat files,
+// it is not installed.
+// Numbers always use the C syntax, whatever the locale of the process is.
+
+#ifndef OTPMML_NUMBERPARSING_HXX
+#define OTPMML_NUMBERPARSING_HXX
+
+#include <openturns/OTprivate.hxx>
+#include <openturns/Exception.hxx>
+
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <stdint.h>
+
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+namespace OTPMML
+{
+
+/* Whether a character is a blank which may surround a number */
+inline OT::Bool IsNumberBlank(const char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* Whether [first, last) starts with a keyword, ignoring case */
+inline OT::Bool StartsWithKeyword(const char * first, const char * last, const char * keyword)
+{
+  for (; *keyword; ++first, ++keyword)
+    if (first == last || (*first | 0x20) != *keyword)
+      return false;
+  return true;
+}
+
+/* The C locale, used whatever the locale of the process is */
+#ifdef _WIN32
+inline _locale_t GetCLocale()
+{
+  static const _locale_t locale = _create_locale(LC_NUMERIC, "C");
+  return locale;
+}
+#else
+inline locale_t GetCLocale()
+{
+  static const locale_t locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+  return locale;
+}
+#endif
+
+/* strtod in the C locale, on a NUL-terminated string */
+inline double StrtodC(const char * text)
+{
+#ifdef _WIN32
+  return _strtod_l(text, NULL, GetCLocale());
+#else
+  return strtod_l(text, NULL, GetCLocale());
+#endif
+}
+
+/* Parse the number which starts at first, like std::from_chars: no blank is skipped.
+   The syntax is [+-]digits[.digits][(e|E)[+-]digits], or inf, infinity, nan (any case).
+   Return the end of the number, or NULL if there is no number or if it overflows */
+inline const char * ParseScalar(const char * first, const char * last, OT::Scalar & value)
+{
+  const char * p = first;
+  const OT::Bool negative = (p != last && *p == '-');
+  if (p != last && (*p == '-' || *p == '+')) ++p;
+  if (p == last) return NULL;
+
+  if (StartsWithKeyword(p, last, "inf"))
+  {
+    value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    return StartsWithKeyword(p, last, "infinity") ? p + 8 : p + 3;
+  }
+  if (StartsWithKeyword(p, last, "nan"))
+  {
+    value = std::numeric_limits<double>::quiet_NaN();
+    return p + 3;
+  }
+
+  // Up to 19 significant digits are accumulated, value is mantissa * 10^exponent
+  uint64_t mantissa = 0;
+  int digits = 0;
+  long exponent = 0;
+  OT::Bool truncated = false;
+  OT::Bool hasDigits = false;
+  for (; p != last && *p >= '0' && *p <= '9'; ++p)
+  {
+    hasDigits = true;
+    if (digits < 19)
+    {
+      if (mantissa != 0 || *p != '0')
+      {
+        mantissa = 10 * mantissa + (*p - '0');
+        ++digits;
+      }
+    }
+    else
+    {
+      ++exponent;
+      truncated = truncated || (*p != '0');
+    }
+  }
+  if (p != last && *p == '.')
+  {
+    for (++p; p != last && *p >= '0' && *p <= '9'; ++p)
+    {
+      hasDigits = true;
+      if (digits < 19)
+      {
+        if (mantissa != 0 || *p != '0')
+        {
+          mantissa = 10 * mantissa + (*p - '0');
+          ++digits;
+        }
+        --exponent;
+      }
+      else
+        truncated = truncated || (*p != '0');
+    }
+  }
+  if (!hasDigits) return NULL;
+
+  // An exponent without digits is not part of the number
+  if (p != last && (*p == 'e' || *p == 'E'))
+  {
+    const char * q = p + 1;
+    const OT::Bool negativeExponent = (q != last && *q == '-');
+    if (q != last && (*q == '-' || *q == '+')) ++q;
+    if (q != last && *q >= '0' && *q <= '9')
+    {
+      long explicitExponent = 0;
+      for (; q != last && *q >= '0' && *q <= '9'; ++q)
+        if (explicitExponent < 100000) explicitExponent = 10 * explicitExponent + (*q - '0');
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+      p = q;
+    }
+  }
+
+  if (mantissa == 0)
+  {
+    value = negative ? -0.0 : 0.0;
+    return p;
+  }
+
+  // When both the mantissa and the power of ten are exact doubles, a single
+  // operation gives the correctly rounded result
+  static const double powersOfTen[] =
+  {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  if (!truncated && mantissa <= (static_cast<uint64_t>(1) << 53) && exponent >= -22 && exponent <= 22)
+  {
+    const double m = negative ? -static_cast<double>(mantissa) : static_cast<double>(mantissa);
+    value = exponent < 0 ? m / powersOfTen[-exponent] : m * powersOfTen[exponent];
+  }
+  else
+  {
+    // Other numbers are rare enough to go through strtod, which also reads the sign
+    char small[64];
+    std::string large;
+    const char * text = small;
+    const std::size_t length = p - first;
+    if (length < sizeof(small))
+    {
+      std::copy(first, p, small);
+      small[length] = '\0';
+    }
+    else
+    {
+      large.assign(first, p);
+      text = large.c_str();
+    }
+    value = StrtodC(text);
+    if (std::abs(value) == std::numeric_limits<double>::infinity())
+      return NULL;
+  }
+  return p;
+}
+
+/* Parse the unsigned integer which starts at first: [+]digits.
+   Return the end of the number, or NULL if there is no number or if it overflows */
+inline const char * ParseUnsignedInteger(const char * first, const char * last, OT::UnsignedInteger & value)
+{
+  const char * p = first;
+  if (p != last && *p == '+') ++p;
+  if (p == last || *p < '0' || *p > '9') return NULL;
+  value = 0;
+  for (; p != last && *p >= '0' && *p <= '9'; ++p)
+  {
+    const OT::UnsignedInteger digit = *p - '0';
+    if (value > (std::numeric_limits<OT::UnsignedInteger>::max() - digit) / 10)
+      return NULL;
+    value = 10 * value + digit;
+  }
+  return p;
+}
+
+/* Convert the whole text of an attribute into a number; blanks around the number are
+   allowed, anything else is an error */
+inline OT::Scalar ToScalar(const char * text, const char * name)
+{
+  const char * first = text;
+  while (IsNumberBlank(*first)) ++first;
+  const char * last = first;
+  while (*last) ++last;
+  OT::Scalar value = 0.0;
+  const char * end = ParseScalar(first, last, value);
+  if (end != NULL)
+    while (end != last && IsNumberBlank(*end)) ++end;
+  if (end != last)
+    throw OT::InvalidArgumentException(HERE) << "Invalid numerical value '" << text << "' for attribute " << name;
+  return value;
+}
+
+inline OT::UnsignedInteger ToUnsignedInteger(const char * text, const char * name)
+{
+  const char * first = text;
+  while (IsNumberBlank(*first)) ++first;
+  const char * last = first;
+  while (*last) ++last;
+  OT::UnsignedInteger value = 0;
+  const char * end = ParseUnsignedInteger(first, last, value);
+  if (end != NULL)
+    while (end != last && IsNumberBlank(*end)) ++end;
+  if (end != last)
+    throw OT::InvalidArgumentException(HERE) << "Invalid integer value '" << text << "' for attribute " << name;
+  return value;
+}
+
+/* Room needed by FormatScalar */
+static const std::size_t ScalarTextSize = 32;
+
+/* Write value as printf("%.16e") does in the C locale, like a stream with the
+   std::scientific format and a precision of 16: numbers are read back exactly.
+   Return the end of the text; a NUL character is written after it */
+inline char * FormatScalar(char * first, const OT::Scalar value)
+{
+#ifdef _WIN32
+  const int length = _snprintf_l(first, ScalarTextSize, "%.16e", GetCLocale(), value);
+#else
+  const locale_t previous = uselocale(GetCLocale());
+  const int length = snprintf(first, ScalarTextSize, "%.16e", value);
+  uselocale(previous);
+#endif
+  return first + length;
+}
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_NUMBERPARSING_HXX */
@@ -0,0 +1,111 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  PMMLBuffer.cxx
+ *  @brief Contents of a PMML document held in memory
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#include "otpmml/PMMLBuffer.hxx"
+#include "MappedFile.hxx"
+
+#include <openturns/Exception.hxx>
+
+#include <cstring>
+
+using namespace OT;
+
+namespace OTPMML
+{
+
+CLASSNAMEINIT(PMMLBuffer)
+
+/* Bytes shared by all copies of a buffer, either owned or mapped */
+struct PMMLBuffer::Storage
+{
+  Storage(const char * data, const std::size_t size)
+    : bytes_(data, data + size)
+    , data_(bytes_.empty() ? NULL : &bytes_[0])
+    , size_(size)
+  {
+  }
+
+  explicit Storage(const FileName & fileName)
+    : file_(new MappedFile(fileName))
+    , data_(file_->data_)
+    , size_(file_->size_)
+    , fileName_(fileName)
+  {
+  }
+
+  std::vector<char> bytes_;
+  Pointer<MappedFile> file_;
+  const char * data_;
+  UnsignedInteger size_;
+  FileName fileName_;
+};
+
+/* Constructor from bytes, which are copied */
+PMMLBuffer::PMMLBuffer(const char * data, const std::size_t size)
+  : Object()
+  , p_storage_(new Storage(data, size))
+{
+  // Nothing to do
+}
+
+PMMLBuffer::PMMLBuffer(const Pointer<Storage> & p_storage)
+  : Object()
+  , p_storage_(p_storage)
+{
+  // Nothing to do
+}
+
+/* Map a file into memory */
+PMMLBuffer PMMLBuffer::MapFile(const FileName & pmmlFile)
+{
+  const Pointer<Storage> p_storage(new Storage(pmmlFile));
+  if (p_storage->file_->error_ != 0)
+    throw FileNotFoundException(HERE) << "Could not open file " << pmmlFile << " for reading, reason: " << std::strerror(p_storage->file_->error_);
+  return PMMLBuffer(p_storage);
+}
+
+/* Bytes accessor */
+const char * PMMLBuffer::getData() const
+{
+  return p_storage_->data_;
+}
+
+UnsignedInteger PMMLBuffer::getSize() const
+{
+  return p_storage_->size_;
+}
+
+/* Mapped file accessor */
+FileName PMMLBuffer::getFileName() const
+{
+  return p_storage_->fileName_;
+}
+
+/* String converter */
+String PMMLBuffer::__repr__() const
+{
+  return OSS(true) << "class=" << PMMLBuffer::GetClassName()
+         << " size=" << getSize()
+         << " fileName=" << getFileName();
+}
+
+} /* namespace OTPMML */
@@ -23,6 +23,9 @@
 #include "otpmml/PMMLDoc.hxx"
 #include "otpmml/PMMLNeuralNetwork.hxx"
 #include "otpmml/PMMLRegressionModel.hxx"
+#include "otpmml/PMMLBuffer.hxx"
+#include "PMMLParsing.hxx"
+#include "LoadRecorder.hxx"
 
 #include <openturns/LinearLeastSquares.hxx>
 #include <openturns/Exception.hxx>
@@ -31,11 +34,12 @@
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
 
-#include <fstream>
-#include <iostream>
+#include <algorithm>
 #include <cstring>
+#include <iostream>
+#include <mutex>
+#include <climits>
 #include <cstdlib>
-#include <cstdio>  // errno
 
 using namespace OT;
 
@@ -43,13 +47,72 @@ using namespace OT;
 namespace OTPMML
 {
 
+/* Initialize libxml2 once for the whole process.  xmlCleanupParser is never called,
+   it would break other threads (or other libraries) still using libxml2 */
+static void InitializeParser()
+{
+  static std::once_flag initialized;
+  std::call_once(initialized, xmlInitParser);
+}
+
+/* Parser is also initialized when the library is loaded */
+static const struct ParserInitializer
+{
+  ParserInitializer()
+  {
+    InitializeParser();
+  }
+} PMMLDoc_ParserInitializer;
+
+/* Remaining bytes of a buffer read by libxml2 through callbacks, for buffers
+   larger than the 2 GiB accepted by xmlReadMemory and xmlReaderForMemory */
+struct PMMLBufferInput
+{
+  const char * data_;
+  UnsignedInteger remaining_;
+};
+
+static int ReadPMMLBufferInput(void * context, char * output, int length)
+{
+  PMMLBufferInput & input = *static_cast<PMMLBufferInput *>(context);
+  const UnsignedInteger size = std::min(input.remaining_, static_cast<UnsignedInteger>(length));
+  std::memcpy(output, input.data_, size);
+  input.data_ += size;
+  input.remaining_ -= size;
+  return static_cast<int>(size);
+}
+
+/* libxml2 calls it once the input is released, even when opening it failed */
+static int ClosePMMLBufferInput(void * context)
+{
+  delete static_cast<PMMLBufferInput *>(context);
+  return 0;
+}
+
+static PMMLBufferInput * NewPMMLBufferInput(const PMMLBuffer & buffer)
+{
+  PMMLBufferInput * p_input = new PMMLBufferInput;
+  p_input->data_ = buffer.getData();
+  p_input->remaining_ = buffer.getSize();
+  return p_input;
+}
+
+/* Origin of a buffer, for error messages */
+static String GetSourceName(const PMMLBuffer & buffer)
+{
+  if (buffer.getFileName().empty()) return "buffer";
+  return OSS() << "file " << buffer.getFileName();
+}
+
 /* Default constructor */
 PMMLDoc::PMMLDoc()
   : document_(NULL)
   , rootNode_(NULL)
-  , xpathContext_(NULL)
   , xpathNsPrefix_()
+  , neuralNetworks_()
+  , regressionModels_()
 {
+  InitializeParser();
   // Create an empty document with a root PMML node
   reset();
 }
@@ -58,35 +121,59 @@ PMMLDoc::PMMLDoc()
 PMMLDoc::PMMLDoc(const FileName & pmmlFile)
   : document_(NULL)
   , rootNode_(NULL)
-  , xpathContext_(NULL)
   , xpathNsPrefix_()
+  , neuralNetworks_()
+  , regressionModels_()
 {
-  std::ifstream inputFile(pmmlFile.c_str());
-  if (!inputFile.is_open())
-    throw FileNotFoundException(HERE) << "Could not open file " << pmmlFile << " for reading, reason: " << std::strerror(errno);
-  inputFile.close();
-  if (!read(pmmlFile)) reset();
+  InitializeParser();
+  // The file is mapped, and parsed from memory
+  if (!read(PMMLBuffer::MapFile(pmmlFile))) reset();
+}
+
+/* Constructor from a buffer */
+PMMLDoc::PMMLDoc(const PMMLBuffer & buffer)
+  : document_(NULL)
+  , rootNode_(NULL)
+  , xpathNsPrefix_()
+  , neuralNetworks_()
+  , regressionModels_()
+{
+  InitializeParser();
+  if (!read(buffer)) reset();
 }
 
 /* Destructor */
 PMMLDoc::~PMMLDoc()
 {
-  if (xpathContext_) xmlXPathFreeContext(xpathContext_);
-  xpathContext_ = NULL;
   if (document_) xmlFreeDoc(document_);
   document_ = NULL;
 }
 
 void PMMLDoc::checkInitialized() const
 {
-  if (document_ == NULL || rootNode_ == NULL || xpathContext_ == NULL)
+  if (document_ == NULL || rootNode_ == NULL)
     throw InvalidArgumentException(HERE) << "Document is uninitialized";
 }
 
+/* Evaluate an XPath query.  A new context is created for each query, so that
+   const methods can be called concurrently on the same document */
+xmlXPathObjectPtr PMMLDoc::evaluateXPathQuery(const String & xpathQuery) const
+{
+  xmlXPathContextPtr xpathContext = xmlXPathNewContext(document_);
+  if (xpathContext == NULL)
+    throw InternalException(HERE) << "Unable to create an XPath context";
+  if (!xpathNsPrefix_.empty())
+    xmlXPathRegisterNs(xpathContext, BAD_CAST "p", BAD_CAST "http://www.dmg.org/PMML-3_0");
+  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST xpathQuery.c_str(), xpathContext);
+  xmlXPathFreeContext(xpathContext);
+  if (xpathObj == NULL)
+    throw InvalidArgumentException(HERE) << "Invalid XPath query " << xpathQuery;
+  return xpathObj;
+}
+
 /* Remove contents */
 void PMMLDoc::reset()
 {
-  if (xpathContext_) xmlXPathFreeContext(xpathContext_);
   if (document_) xmlFreeDoc(document_);
 
   // Create an empty document with a root PMML node
@@ -98,40 +185,91 @@ void PMMLDoc::reset()
   xmlNsPtr ns = xmlNewNs(rootNode_, BAD_CAST "http://www.dmg.org/PMML-3_0", NULL);
   xmlSetNs(rootNode_, ns);
 
-  // Create an XPath context
-  xpathContext_ = xmlXPathNewContext(document_);
+  // XPath queries use the namespace
   xpathNsPrefix_ = String("p:");
-  xmlXPathRegisterNs(xpathContext_,  BAD_CAST "p", BAD_CAST "http://www.dmg.org/PMML-3_0");
+  indexModels();
 }
 
 /* Read a file */
 Bool PMMLDoc::read(const FileName & pmmlFile)
 {
-  if (xmlFirstElementChild(rootNode_) != NULL)
+  try
+  {
+    return read(PMMLBuffer::MapFile(pmmlFile));
+  }
+  catch (const FileNotFoundException & exc)
   {
-    std::cerr << "WARNING: document is not empty, it is now destroyed before reading file " << pmmlFile << std::endl;
-    xmlXPathFreeContext(xpathContext_);
-    xpathContext_ = NULL;
-    xmlFreeDoc(document_);
-    document_ = NULL;
+    std::cerr << "Unable to parse XML file " << pmmlFile << ", reason: " << exc.what() << std::endl;
+    return false;
   }
+}
 
-  document_ = xmlParseFile(pmmlFile.c_str());
+/* Read a buffer */
+Bool PMMLDoc::read(const PMMLBuffer & buffer)
+{
+  if (xmlFirstElementChild(rootNode_) != NULL)
+    std::cerr << "WARNING: document is not empty, it is now destroyed before reading " << GetSourceName(buffer) << std::endl;
+  if (document_) xmlFreeDoc(document_);
+  document_ = NULL;
+  rootNode_ = NULL;
+  indexModels();
+
+  // xmlReadMemory does not accept buffers larger than 2 GiB, they are read through callbacks
+  const char * url = buffer.getFileName().empty() ? NULL : buffer.getFileName().c_str();
+  if (buffer.getSize() <= static_cast<UnsignedInteger>(INT_MAX))
+    document_ = xmlReadMemory(buffer.getData(), static_cast<int>(buffer.getSize()), url, NULL, 0);
+  else
+    document_ = xmlReadIO(ReadPMMLBufferInput, ClosePMMLBufferInput, NewPMMLBufferInput(buffer), url, NULL, 0);
   if (document_ == NULL)
   {
-    std::cerr << "Unable to parse XML file " << pmmlFile << std::endl;
+    std::cerr << "Unable to parse XML " << GetSourceName(buffer) << std::endl;
     return false;
   }
   rootNode_ = xmlDocGetRootElement(document_);
 
-  // Create an XPath context
-  xpathContext_ = xmlXPathNewContext(document_);
-  if (rootNode_->ns)
+  // XPath queries use the namespace only if it is declared
+  xpathNsPrefix_ = (rootNode_ && rootNode_->ns) ? String("p:") : String();
+  indexModels();
+  return (rootNode_ != NULL);
+}
+
+/* Rebuild the index of models.  Models are children of the root node */
+void PMMLDoc::indexModels()
+{
+  neuralNetworks_ = ModelIndex();
+  regressionModels_ = ModelIndex();
+  if (rootNode_ == NULL) return;
+  for (xmlNodePtr cur_node = rootNode_->children; cur_node != NULL; cur_node = cur_node->next)
+    indexModel(cur_node);
+}
+
+void PMMLDoc::indexModel(xmlNodePtr node)
+{
+  ModelIndex * index = NULL;
+  if (IsElement(node, "NeuralNetwork"))
+    index = &neuralNetworks_;
+  else if (IsElement(node, "RegressionModel"))
+    index = &regressionModels_;
+  else
+    return;
+  const char * attribute = GetAttribute(node, "modelName");
+  const String name(attribute ? attribute : "");
+  index->names_.add(name);
+  if (name.empty()) return;
+  // Only the first model of a given name can be looked up
+  index->nodes_.insert(std::make_pair(name, node));
+  if (index->firstNamedNode_ == NULL)
   {
-    xpathNsPrefix_ = String("p:");
-    xmlXPathRegisterNs(xpathContext_,  BAD_CAST "p", BAD_CAST "http://www.dmg.org/PMML-3_0");
+    index->firstNamedNode_ = node;
+    index->firstName_ = name;
   }
-  return (rootNode_ != NULL);
+}
+
+const PMMLDoc::ModelIndex & PMMLDoc::getModelIndex(const String & category) const
+{
+  if (category == "NeuralNetwork") return neuralNetworks_;
+  if (category == "RegressionModel") return regressionModels_;
+  throw InvalidArgumentException(HERE) << "Unknown model category " << category;
 }
 
 /* Dump PMML into a file */
@@ -143,10 +281,7 @@ Bool PMMLDoc::write(const FileName & pmmlFile) const
 UnsignedInteger PMMLDoc::getNumberOfNeuralNetworks() const
 {
   checkInitialized();
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST (String("count(") + xpathNsPrefix_ + String("PMML/") + xpathNsPrefix_ + String("NeuralNetwork)")).c_str(), xpathContext_);
-  const UnsignedInteger result = static_cast<UnsignedInteger>(xpathObj->floatval);
-  xmlXPathFreeObject(xpathObj);
-  return result;
+  return neuralNetworks_.names_.getSize();
 }
 
 PMMLDoc::StringCollection PMMLDoc::getNeuralNetworkModelNames() const
@@ -155,64 +290,42 @@ PMMLDoc::StringCollection PMMLDoc::getNeuralNetworkModelNames() const
 }
 
 PMMLNeuralNetwork PMMLDoc::getNeuralNetwork(const OT::String & modelName) const
+{
+  String name;
+  const xmlNodePtr node = getModelNode("NeuralNetwork", modelName, name);
+  return PMMLNeuralNetwork(this, name, node);
+}
+
+xmlNodePtr PMMLDoc::getModelNode(const String & category, const String & modelName, String & name) const
 {
   checkInitialized();
-  String query(OSS() << "/" << xpathNsPrefix_ << "PMML/" << xpathNsPrefix_ << "NeuralNetwork[@modelName='" << modelName << "']/@modelName");
+  // Without a name, the first named model is selected
+  const ModelIndex & index = getModelIndex(category);
   if (modelName.empty())
   {
-    Collection<String> modelNames = getNeuralNetworkModelNames();
-    query = OSS() << "/" << xpathNsPrefix_ << "PMML/" << xpathNsPrefix_ << "NeuralNetwork[@modelName='" << modelNames[0] << "']/@modelName";
-  }
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST query.c_str(), xpathContext_);
-  xmlNodePtr node = NULL;
-  String name;
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
-  {
-    node = xpathObj->nodesetval->nodeTab[0]->parent;
-    xmlChar * text = xmlNodeListGetString(document_, xpathObj->nodesetval->nodeTab[0]->xmlChildrenNode, 1);
-    name = String(reinterpret_cast<char*>(text));
-    xmlFree(text);
-  }
-  xmlXPathFreeObject(xpathObj);
-  if (name.empty())
-  {
-    throw InvalidArgumentException(HERE) << "Unable to find NeuralNetwork named '" << modelName << "', models found are: " << getNeuralNetworkModelNames();
+    if (index.firstNamedNode_ == NULL)
+      throw InvalidArgumentException(HERE) << "Unable to find " << category << " named '" << modelName << "', models found are: " << index.names_;
+    name = index.firstName_;
+    return index.firstNamedNode_;
   }
-  return PMMLNeuralNetwork(this, name, node);
+  const std::unordered_map<String, xmlNodePtr>::const_iterator it = index.nodes_.find(modelName);
+  if (it == index.nodes_.end())
+    throw InvalidArgumentException(HERE) << "Unable to find " << category << " named '" << modelName << "', models found are: " << index.names_;
+  name = modelName;
+  return it->second;
 }
 
 PMMLDoc::StringCollection PMMLDoc::getModelNames(const String & category) const
 {
   checkInitialized();
-  String query(String("/") + xpathNsPrefix_ + String("PMML/") + xpathNsPrefix_ + category);
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST query.c_str(), xpathContext_);
-  StringCollection result;
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      String name;
-      for (xmlAttr *cur_attr = xpathObj->nodesetval->nodeTab[cnt]->properties;
-           cur_attr != NULL; cur_attr = cur_attr->next)
-      {
-        if (cur_attr->type == XML_ATTRIBUTE_NODE && 0 == xmlStrcmp(cur_attr->name, BAD_CAST "modelName"))
-        {
-          name = reinterpret_cast<const char*>(cur_attr->children->content);
-          break;
-        }
-      }
-      result.add(name);
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-  return result;
+  return getModelIndex(category).names_;
 }
 
 Scalar PMMLDoc::getXPathQueryScalar(const String & xpathQuery) const
 {
   checkInitialized();
   Scalar result = 0.0;
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST xpathQuery.c_str(), xpathContext_);
+  xmlXPathObjectPtr xpathObj = evaluateXPathQuery(xpathQuery);
   if (!xmlXPathIsNaN(xpathObj->floatval)) result = static_cast<Scalar>(xpathObj->floatval);
   xmlXPathFreeObject(xpathObj);
   return result;
@@ -222,7 +335,7 @@ String PMMLDoc::getXPathQueryString(const String & xpathQuery) const
 {
   checkInitialized();
   String result;
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST xpathQuery.c_str(), xpathContext_);
+  xmlXPathObjectPtr xpathObj = evaluateXPathQuery(xpathQuery);
   if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
   {
     xmlChar * text = xmlNodeListGetString(document_, xpathObj->nodesetval->nodeTab[0]->xmlChildrenNode, 1);
@@ -236,13 +349,7 @@ String PMMLDoc::getXPathQueryString(const String & xpathQuery) const
 UnsignedInteger PMMLDoc::getNumberOfRegressionModels() const
 {
   checkInitialized();
-  UnsignedInteger count = 0;
-  for (xmlNode *cur_node = rootNode_->children; cur_node != NULL; cur_node = cur_node->next)
-  {
-    if (cur_node->type == XML_ELEMENT_NODE && 0 == xmlStrcmp(cur_node->name, BAD_CAST "RegressionModel"))
-      ++count;
-  }
-  return count;
+  return regressionModels_.names_.getSize();
 }
 
 PMMLDoc::StringCollection PMMLDoc::getRegressionModelNames() const
@@ -252,29 +359,152 @@ PMMLDoc::StringCollection PMMLDoc::getRegressionModelNames() const
 
 PMMLRegressionModel PMMLDoc::getRegressionModel(const OT::String & modelName) const
 {
-  checkInitialized();
-  String query(OSS() << "/" << xpathNsPrefix_ << "PMML/" << xpathNsPrefix_ << "RegressionModel[@modelName='" << modelName << "']/@modelName");
-  if (modelName.empty())
+  String name;
+  const xmlNodePtr node = getModelNode("RegressionModel", modelName, name);
+  return PMMLRegressionModel(this, name, node);
+}
+
+xmlTextReaderPtr PMMLDoc::OpenReader(const PMMLBuffer & buffer)
+{
+  InitializeParser();
+  // xmlReaderForMemory does not accept buffers larger than 2 GiB, they are read through callbacks;
+  // the reader uses the bytes of the buffer until it is freed
+  const char * url = buffer.getFileName().empty() ? NULL : buffer.getFileName().c_str();
+  xmlTextReaderPtr reader = NULL;
+  if (buffer.getSize() <= static_cast<UnsignedInteger>(INT_MAX))
+    reader = xmlReaderForMemory(buffer.getData(), static_cast<int>(buffer.getSize()), url, NULL, 0);
+  else
+    reader = xmlReaderForIO(ReadPMMLBufferInput, ClosePMMLBufferInput, NewPMMLBufferInput(buffer), url, NULL, 0);
+  if (reader == NULL)
+    throw InvalidArgumentException(HERE) << "Unable to parse XML " << GetSourceName(buffer);
+  return reader;
+}
+
+xmlTextReaderPtr PMMLDoc::OpenModelReader(const PMMLBuffer & buffer, const String & category, const String & modelName, String & name)
+{
+  xmlTextReaderPtr reader = OpenReader(buffer);
+
+  // Models are children of the root element, the subtree of any other child is skipped
+  StringCollection modelNames;
+  int status = xmlTextReaderRead(reader);
+  while (status == 1)
+  {
+    if (xmlTextReaderDepth(reader) != 1)
+    {
+      status = xmlTextReaderRead(reader);
+      continue;
+    }
+    if (IsElement(reader, category.c_str()))
+    {
+      const char * attribute = GetAttribute(reader, "modelName");
+      name = attribute ? attribute : "";
+      modelNames.add(name);
+      if (!name.empty() && (modelName.empty() || name == modelName))
+        return reader;
+    }
+    status = xmlTextReaderNext(reader);
+  }
+  xmlFreeTextReader(reader);
+  if (status == -1)
+    throw InvalidArgumentException(HERE) << "Unable to parse XML " << GetSourceName(buffer);
+  throw InvalidArgumentException(HERE) << "Unable to find " << category << " named '" << modelName << "', models found are: " << modelNames;
+}
+
+PMMLNeuralNetwork PMMLDoc::StreamNeuralNetwork(const FileName & pmmlFile, const String & modelName, const Bool headerOnly)
+{
+  return StreamNeuralNetwork(PMMLBuffer::MapFile(pmmlFile), modelName, headerOnly);
+}
+
+PMMLNeuralNetwork PMMLDoc::StreamNeuralNetwork(const PMMLBuffer & buffer, const String & modelName, const Bool headerOnly)
+{
+  String name;
+  xmlTextReaderPtr reader = OpenModelReader(buffer, "NeuralNetwork", modelName, name);
+  LoadRecorder::StartPhase(LoadProfile::PARSE);
+  try
+  {
+    const PMMLNeuralNetwork result(name, reader, headerOnly);
+    LoadRecorder::StartPhase(LoadProfile::CLEANUP);
+    xmlFreeTextReader(reader);
+    return result;
+  }
+  catch (...)
   {
-    Collection<String> modelNames = getRegressionModelNames();
-    query = OSS() << "/" << xpathNsPrefix_ << "PMML/" << xpathNsPrefix_ << "RegressionModel[@modelName='" << modelNames[0] << "']/@modelName";
+    xmlFreeTextReader(reader);
+    throw;
   }
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST query.c_str(), xpathContext_);
-  xmlNodePtr node = NULL;
+}
+
+PMMLRegressionModel PMMLDoc::StreamRegressionModel(const FileName & pmmlFile, const String & modelName)
+{
+  return StreamRegressionModel(PMMLBuffer::MapFile(pmmlFile), modelName);
+}
+
+PMMLRegressionModel PMMLDoc::StreamRegressionModel(const PMMLBuffer & buffer, const String & modelName)
+{
   String name;
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
+  xmlTextReaderPtr reader = OpenModelReader(buffer, "RegressionModel", modelName, name);
+  LoadRecorder::StartPhase(LoadProfile::PARSE);
+  try
   {
-    node = xpathObj->nodesetval->nodeTab[0]->parent;
-    xmlChar * text = xmlNodeListGetString(document_, xpathObj->nodesetval->nodeTab[0]->xmlChildrenNode, 1);
-    name = String(reinterpret_cast<char*>(text));
-    xmlFree(text);
+    const PMMLRegressionModel result(name, reader);
+    LoadRecorder::StartPhase(LoadProfile::CLEANUP);
+    xmlFreeTextReader(reader);
+    return result;
   }
-  xmlXPathFreeObject(xpathObj);
-  if (name.empty())
+  catch (...)
   {
-    throw InvalidArgumentException(HERE) << "Unable to find RegressionModel named '" << modelName << "', models found are: " << getRegressionModelNames();
+    xmlFreeTextReader(reader);
+    throw;
   }
-  return PMMLRegressionModel(this, name, node);
+}
+
+void PMMLDoc::StreamModels(const FileName & pmmlFile, PMMLNeuralNetworkCollection & networks, PMMLRegressionModelCollection & regressions)
+{
+  StreamModels(PMMLBuffer::MapFile(pmmlFile), networks, regressions);
+}
+
+void PMMLDoc::StreamModels(const PMMLBuffer & buffer, PMMLNeuralNetworkCollection & networks, PMMLRegressionModelCollection & regressions)
+{
+  xmlTextReaderPtr reader = OpenReader(buffer);
+  int status = 0;
+  try
+  {
+    // As in OpenModelReader, unnamed models are ignored
+    status = xmlTextReaderRead(reader);
+    while (status == 1)
+    {
+      if (xmlTextReaderDepth(reader) != 1)
+      {
+        status = xmlTextReaderRead(reader);
+        continue;
+      }
+      const Bool isNeuralNetwork = IsElement(reader, "NeuralNetwork");
+      const char * attribute = GetAttribute(reader, "modelName");
+      const String name(attribute ? attribute : "");
+      if ((isNeuralNetwork || IsElement(reader, "RegressionModel")) && !name.empty())
+      {
+        if (isNeuralNetwork)
+          networks.add(PMMLNeuralNetwork(name, reader));
+        else
+          regressions.add(PMMLRegressionModel(name, reader));
+        // The reader is now on the end of the model, or on the next node if the model is empty
+        if (xmlTextReaderDepth(reader) != 1 || xmlTextReaderNodeType(reader) == XML_READER_TYPE_END_ELEMENT)
+          status = xmlTextReaderRead(reader);
+        else
+          status = 1;
+        continue;
+      }
+      status = xmlTextReaderNext(reader);
+    }
+  }
+  catch (...)
+  {
+    xmlFreeTextReader(reader);
+    throw;
+  }
+  xmlFreeTextReader(reader);
+  if (status == -1)
+    throw InvalidArgumentException(HERE) << "Unable to parse XML " << GetSourceName(buffer);
 }
 
 void PMMLDoc::addHeader()
@@ -338,7 +568,7 @@ void PMMLDoc::addRegressionModel(const String & modelName, LinearLeastSquares re
 
   // Update dictionary
   String query(OSS() << "/" << xpathNsPrefix_ << "PMML/" << xpathNsPrefix_ << "DataDictionary");
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST query.c_str(), xpathContext_);
+  xmlXPathObjectPtr xpathObj = evaluateXPathQuery(query);
   xmlNodePtr dictionnaryNode = NULL;
   Bool addNewline(true);
   if(xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
@@ -412,7 +642,7 @@ void PMMLDoc::addRegressionModel(const String & modelName, LinearLeastSquares re
     {
       if (cur_attr->type == XML_ATTRIBUTE_NODE && 0 == xmlStrcmp(cur_attr->name, BAD_CAST "numberOfFields"))
       {
-        UnsignedInteger numberOfFields = strtol(reinterpret_cast<const char*>(cur_attr->children->content), NULL, 10);
+        UnsignedInteger numberOfFields = ToUnsignedInteger(reinterpret_cast<const char*>(cur_attr->children->content), "numberOfFields");
         numberOfFields += 1 + linear.getNbRows();
         xmlSetProp(dictionnaryNode, BAD_CAST "numberOfFields", BAD_CAST String(OSS() << numberOfFields).c_str());
         break;
@@ -430,6 +660,7 @@ void PMMLDoc::addRegressionModel(const String & modelName, LinearLeastSquares re
   xmlNewProp(newRegressionNode, BAD_CAST "functionName", BAD_CAST "regression");
   xmlNewProp(newRegressionNode, BAD_CAST "algorithmName", BAD_CAST "linearRegression");
   xmlNewProp(newRegressionNode, BAD_CAST "targetFieldName", BAD_CAST descriptionOut[0].c_str());
+  indexModel(newRegressionNode);
 
   xmlNodeAddContent(newRegressionNode, BAD_CAST "\n    ");
   xmlNodePtr newMiningSchemaNode = xmlNewChild(newRegressionNode, 0, BAD_CAST "MiningSchema", 0);
@@ -21,329 +21,476 @@
  */
 #include "otpmml/PMMLNeuralNetwork.hxx"
 #include "otpmml/PMMLDoc.hxx"
+#include "PMMLParsing.hxx"
+#include "LoadRecorder.hxx"
 
 #include <openturns/SymbolicFunction.hxx>
+#include <openturns/Exception.hxx>
 
 #include <libxml/parser.h>
-#include <libxml/xpath.h>
-#include <libxml/xpathInternals.h>
 
-#include <iostream>
-#include <cstring>
-#include <cstdlib>
+#include <map>
 
 using namespace OT;
 
 namespace OTPMML
 {
 
+/* Read orig and norm attributes of the <LinearNorm> elements of a <NeuralInput> or <NeuralOutput> element,
+   and the field attribute of its <NormContinuous> element */
+static void ReadLinearNorms(const xmlNode * node, Point & orig, Point & norm, String & field)
+{
+  for (const xmlNode * derived = node->children; derived != NULL; derived = derived->next)
+  {
+    if (!IsElement(derived, "DerivedField")) continue;
+    for (const xmlNode * normContinuous = derived->children; normContinuous != NULL; normContinuous = normContinuous->next)
+    {
+      if (normContinuous->type != XML_ELEMENT_NODE) continue;
+      const char * fieldName = GetAttribute(normContinuous, "field");
+      if (fieldName && field.empty())
+        field = fieldName;
+      if (!IsElement(normContinuous, "NormContinuous")) continue;
+      for (const xmlNode * linearNorm = normContinuous->children; linearNorm != NULL; linearNorm = linearNorm->next)
+      {
+        if (!IsElement(linearNorm, "LinearNorm")) continue;
+        if (GetAttribute(linearNorm, "orig"))
+          orig.add(GetScalarAttribute(linearNorm, "orig"));
+        if (GetAttribute(linearNorm, "norm"))
+          norm.add(GetScalarAttribute(linearNorm, "norm"));
+      }
+    }
+  }
+}
+
+/* Build the coefficients of a normalization; they are null if some are missing */
+static Sample BuildNormalization(const UnsignedInteger size, const Point & orig, const Point & norm)
+{
+  Sample result(size, 4);
+  Description description(4);
+  description[0] = "orig0";
+  description[1] = "orig1";
+  description[2] = "norm0";
+  description[3] = "norm1";
+  result.setDescription(description);
+  if (orig.getDimension() == 2 * size)
+    for (UnsignedInteger cnt = 0; cnt < orig.getDimension(); ++cnt)
+      result(cnt / 2, cnt & 1) = orig[cnt];
+  if (norm.getDimension() == 2 * size)
+    for (UnsignedInteger cnt = 0; cnt < norm.getDimension(); ++cnt)
+      result(cnt / 2, 2 + (cnt & 1)) = norm[cnt];
+  return result;
+}
+
+/* Builds layers in document order; weights connect neurons of the previous layer,
+   or inputs, to neurons of the layer, and are stored as soon as connections are read */
+struct PMMLNeuralNetwork::LayerReader
+{
+  explicit LayerReader(PMMLNeuralNetwork & model)
+    : model_(model)
+    , started_(false)
+  {
+  }
+
+  /** Start a layer; inputs must have been read before */
+  void begin(const String & activationFunction, const UnsignedInteger numberOfNeurons)
+  {
+    end();
+    const UnsignedInteger layerIndex = model_.layers_.size();
+    Indices fromIds;
+    if (layerIndex == 0)
+    {
+      fromIds = model_.inputIds_;
+      if (fromIds.getSize() != model_.numberOfInputs_)
+      {
+        fromIds = Indices(model_.numberOfInputs_);
+        fromIds.fill();
+      }
+    }
+    else
+      fromIds = model_.layers_.back().neuronIds_;
+    fromIndices_.clear();
+    for (UnsignedInteger i = 0; i < fromIds.getSize(); ++i)
+      fromIndices_[fromIds[i]] = i;
+    layer_ = Layer();
+    layer_.activationFunction_ = activationFunction;
+    layer_.numberOfNeurons_ = numberOfNeurons;
+    if (!model_.headerOnly_ && layerIndex < model_.numberOfLayers_ && !fromIds.isEmpty() && numberOfNeurons > 0)
+      layer_.weights_ = Matrix(fromIds.getSize(), numberOfNeurons);
+    bias_ = Point();
+    started_ = true;
+  }
+
+  void addNeuron(const UnsignedInteger id, const Scalar bias)
+  {
+    layer_.neuronIds_.add(id);
+    bias_.add(bias);
+  }
+
+  /** Add a connection to the last neuron */
+  void addConnection(const UnsignedInteger from, const Scalar weight)
+  {
+    const UnsignedInteger index = layer_.neuronIds_.getSize() - 1;
+    if (layer_.neuronIds_.isEmpty() || index >= layer_.weights_.getNbColumns()) return;
+    std::map<UnsignedInteger, UnsignedInteger>::const_iterator it = fromIndices_.find(from);
+    if (it != fromIndices_.end())
+      layer_.weights_(it->second, index) = weight;
+  }
+
+  /** Append the current layer to the model */
+  void end()
+  {
+    if (!started_) return;
+    // Neurons are ignored if their number is inconsistent
+    if (layer_.neuronIds_.getSize() == layer_.numberOfNeurons_)
+      layer_.bias_ = bias_;
+    else
+    {
+      layer_.bias_ = Point(layer_.numberOfNeurons_);
+      layer_.neuronIds_ = Indices();
+      layer_.weights_ = Matrix();
+    }
+    model_.layers_.push_back(layer_);
+    started_ = false;
+  }
+
+  PMMLNeuralNetwork & model_;
+  Layer layer_;
+  Point bias_;
+  std::map<UnsignedInteger, UnsignedInteger> fromIndices_;
+  Bool started_;
+};
+
 /* Default constructor */
 PMMLNeuralNetwork::PMMLNeuralNetwork(const PMMLDoc * pmml, const String & modelName, const xmlNodePtr & node)
-  : pmml_(pmml)
-  , modelName_(modelName)
-  , node_(node)
+  : modelName_(modelName)
+  , numberOfInputs_(0)
+  , numberOfOutputs_(0)
+  , numberOfLayers_(0)
+  , headerOnly_(false)
 {
+  pmml->checkInitialized();
+  readModel(node);
 }
 
-/** Get model name */
-String PMMLNeuralNetwork::getModelName() const
+/* Constructor from a reader positioned on a <NeuralNetwork> element */
+PMMLNeuralNetwork::PMMLNeuralNetwork(const String & modelName, xmlTextReaderPtr reader, const Bool headerOnly)
+  : modelName_(modelName)
+  , numberOfInputs_(0)
+  , numberOfOutputs_(0)
+  , numberOfLayers_(0)
+  , headerOnly_(headerOnly)
 {
-  return modelName_;
+  readModel(reader, headerOnly);
+}
+
+/** Fill the model by walking once the <NeuralNetwork> element */
+void PMMLNeuralNetwork::readModel(const xmlNodePtr & node)
+{
+  if (node == NULL) return;
+  numberOfLayers_ = GetIntegerAttribute(node, "numberOfLayers");
+  const char * defaultActivation = GetAttribute(node, "activationFunction");
+
+  LayerReader layerReader(*this);
+  Point inputsOrig;
+  Point inputsNorm;
+  Point outputsOrig;
+  Point outputsNorm;
+  for (const xmlNode * child = node->children; child != NULL; child = child->next)
+  {
+    if (IsElement(child, "NeuralInputs"))
+    {
+      LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+      numberOfInputs_ = GetIntegerAttribute(child, "numberOfInputs");
+      for (const xmlNode * input = child->children; input != NULL; input = input->next)
+      {
+        if (!IsElement(input, "NeuralInput")) continue;
+        String field;
+        ReadLinearNorms(input, inputsOrig, inputsNorm, field);
+        inputIds_.add(GetIntegerAttribute(input, "id"));
+        inputNames_.add(field);
+      }
+    }
+    else if (IsElement(child, "NeuralOutputs"))
+    {
+      LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+      numberOfOutputs_ = GetIntegerAttribute(child, "numberOfOutputs");
+      for (const xmlNode * output = child->children; output != NULL; output = output->next)
+      {
+        if (!IsElement(output, "NeuralOutput")) continue;
+        String field;
+        ReadLinearNorms(output, outputsOrig, outputsNorm, field);
+        outputNames_.add(field);
+      }
+    }
+    else if (IsElement(child, "NeuralLayer"))
+    {
+      LoadRecorder::StartPhase(LoadProfile::WEIGHTS);
+      const char * activation = GetAttribute(child, "activationFunction");
+      layerReader.begin(activation ? activation : (defaultActivation ? defaultActivation : ""), GetIntegerAttribute(child, "numberOfNeurons"));
+      for (const xmlNode * neuron = child->children; neuron != NULL; neuron = neuron->next)
+      {
+        if (!IsElement(neuron, "Neuron")) continue;
+        layerReader.addNeuron(GetIntegerAttribute(neuron, "id"), GetScalarAttribute(neuron, "bias"));
+        for (const xmlNode * con = neuron->children; con != NULL; con = con->next)
+        {
+          if (!IsElement(con, "Con") || !GetAttribute(con, "from") || !GetAttribute(con, "weight")) continue;
+          layerReader.addConnection(GetIntegerAttribute(con, "from"), GetScalarAttribute(con, "weight"));
+        }
+      }
+    }
+  }
+  LoadRecorder::StartPhase(LoadProfile::WEIGHTS);
+  layerReader.end();
+  LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+  inputsNormalization_ = BuildNormalization(numberOfInputs_, inputsOrig, inputsNorm);
+  outputsNormalization_ = BuildNormalization(numberOfOutputs_, outputsOrig, outputsNorm);
+}
+
+/* Elements of a <NeuralNetwork> subtree which are read from a stream */
+enum NeuralNetworkElement
+{
+  IGNORED_ELEMENT = 0,
+  NEURAL_NETWORK,
+  NEURAL_INPUTS,
+  NEURAL_INPUT,
+  NEURAL_OUTPUTS,
+  NEURAL_OUTPUT,
+  NEURAL_LAYER,
+  NEURON,
+  DERIVED_FIELD,
+  NORM_CONTINUOUS
+};
+
+/** Fill the model by reading once the <NeuralNetwork> element */
+void PMMLNeuralNetwork::readModel(xmlTextReaderPtr reader, const Bool headerOnly)
+{
+  numberOfLayers_ = GetIntegerAttribute(reader, "numberOfLayers");
+  const char * attribute = GetAttribute(reader, "activationFunction");
+  const String defaultActivation(attribute ? attribute : "");
+
+  LayerReader layerReader(*this);
+  Point inputsOrig;
+  Point inputsNorm;
+  Point outputsOrig;
+  Point outputsNorm;
+  // <LinearNorm> coefficients of the current <NeuralInput> or <NeuralOutput>, and its field
+  Point * orig = NULL;
+  Point * norm = NULL;
+  String field;
+  // Element opened at each depth below <NeuralNetwork>, deeper elements are not needed
+  const int depth = xmlTextReaderDepth(reader);
+  const int maximumLevel = 5;
+  NeuralNetworkElement opened[maximumLevel + 1];
+  opened[0] = NEURAL_NETWORK;
+  // The subtree of an element is skipped by moving to its next sibling
+  Bool skipSubtree = false;
+  int status = xmlTextReaderRead(reader);
+  for (; status == 1; status = skipSubtree ? xmlTextReaderNext(reader) : xmlTextReaderRead(reader))
+  {
+    skipSubtree = false;
+    const int level = xmlTextReaderDepth(reader) - depth;
+    if (level <= 0) break;
+    if (level > maximumLevel || xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) continue;
+    const NeuralNetworkElement parent = opened[level - 1];
+    NeuralNetworkElement element = IGNORED_ELEMENT;
+    if (parent == NEURAL_NETWORK)
+    {
+      if (IsElement(reader, "NeuralInputs"))
+      {
+        LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+        element = NEURAL_INPUTS;
+        numberOfInputs_ = GetIntegerAttribute(reader, "numberOfInputs");
+      }
+      else if (IsElement(reader, "NeuralOutputs"))
+      {
+        LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+        element = NEURAL_OUTPUTS;
+        numberOfOutputs_ = GetIntegerAttribute(reader, "numberOfOutputs");
+      }
+      else if (IsElement(reader, "NeuralLayer"))
+      {
+        LoadRecorder::StartPhase(LoadProfile::WEIGHTS);
+        element = NEURAL_LAYER;
+        attribute = GetAttribute(reader, "activationFunction");
+        const String activation(attribute ? attribute : defaultActivation);
+        layerReader.begin(activation, GetIntegerAttribute(reader, "numberOfNeurons"));
+        skipSubtree = headerOnly;
+      }
+      else
+        LoadRecorder::StartPhase(LoadProfile::PARSE);
+    }
+    else if (parent == NEURAL_INPUTS && IsElement(reader, "NeuralInput"))
+    {
+      element = NEURAL_INPUT;
+      inputIds_.add(GetIntegerAttribute(reader, "id"));
+      inputNames_.add(String());
+      field = String();
+      orig = &inputsOrig;
+      norm = &inputsNorm;
+    }
+    else if (parent == NEURAL_OUTPUTS && IsElement(reader, "NeuralOutput"))
+    {
+      element = NEURAL_OUTPUT;
+      outputNames_.add(String());
+      field = String();
+      orig = &outputsOrig;
+      norm = &outputsNorm;
+    }
+    else if (parent == NEURAL_LAYER && IsElement(reader, "Neuron"))
+    {
+      element = NEURON;
+      layerReader.addNeuron(GetIntegerAttribute(reader, "id"), GetScalarAttribute(reader, "bias"));
+    }
+    else if (parent == NEURON && IsElement(reader, "Con"))
+    {
+      const char * from = GetAttribute(reader, "from");
+      const UnsignedInteger fromId = from ? ToUnsignedInteger(from, "from") : 0;
+      const char * weight = GetAttribute(reader, "weight");
+      if (from && weight)
+        layerReader.addConnection(fromId, ToScalar(weight, "weight"));
+    }
+    else if ((parent == NEURAL_INPUT || parent == NEURAL_OUTPUT) && IsElement(reader, "DerivedField"))
+      element = DERIVED_FIELD;
+    else if (parent == DERIVED_FIELD)
+    {
+      // The first field attribute names the input
+      const char * fieldName = GetAttribute(reader, "field");
+      if (fieldName && field.empty())
+      {
+        field = fieldName;
+        if (opened[level - 2] == NEURAL_INPUT)
+          inputNames_[inputNames_.getSize() - 1] = field;
+        else
+          outputNames_[outputNames_.getSize() - 1] = field;
+      }
+      if (IsElement(reader, "NormContinuous"))
+        element = NORM_CONTINUOUS;
+    }
+    else if (parent == NORM_CONTINUOUS && IsElement(reader, "LinearNorm"))
+    {
+      if (GetAttribute(reader, "orig"))
+        orig->add(GetScalarAttribute(reader, "orig"));
+      if (GetAttribute(reader, "norm"))
+        norm->add(GetScalarAttribute(reader, "norm"));
+    }
+    opened[level] = element;
+  }
+  if (status == -1)
+    throw InvalidArgumentException(HERE) << "Unable to read <NeuralNetwork> element named '" << modelName_ << "'";
+  LoadRecorder::StartPhase(LoadProfile::WEIGHTS);
+  layerReader.end();
+  LoadRecorder::StartPhase(LoadProfile::NORMALIZATION);
+  inputsNormalization_ = BuildNormalization(numberOfInputs_, inputsOrig, inputsNorm);
+  outputsNormalization_ = BuildNormalization(numberOfOutputs_, outputsOrig, outputsNorm);
 }
 
-/** Set XPath context to node_ */
-void PMMLNeuralNetwork::setXPathContext() const
+/** Get model name */
+String PMMLNeuralNetwork::getModelName() const
 {
-  pmml_->checkInitialized();
-  pmml_->xpathContext_->node = node_;
+  return modelName_;
 }
 
 /** Get number of inputs */
 UnsignedInteger PMMLNeuralNetwork::getNumberOfInputs() const
 {
-  setXPathContext();
-  return pmml_->getXPathQueryScalar(String("number(./") + pmml_->xpathNsPrefix_ + String("NeuralInputs/@numberOfInputs)"));
+  return numberOfInputs_;
 }
 
 /** Get number of outputs */
 UnsignedInteger PMMLNeuralNetwork::getNumberOfOutputs() const
 {
-  setXPathContext();
-  return pmml_->getXPathQueryScalar(String("number(./") + pmml_->xpathNsPrefix_ + String("NeuralOutputs/@numberOfOutputs)"));
+  return numberOfOutputs_;
 }
 
 /** Get number of layers (= 1 + hidden) */
 UnsignedInteger PMMLNeuralNetwork::getNumberOfLayers() const
 {
-  setXPathContext();
-  return pmml_->getXPathQueryScalar("number(./@numberOfLayers)");
+  return numberOfLayers_;
 }
 
 /** Get number of neurons in the given layer */
 UnsignedInteger PMMLNeuralNetwork::getLayerSize(UnsignedInteger index) const
 {
-  setXPathContext();
-  String query(OSS() << "number(./" << pmml_->xpathNsPrefix_ << "NeuralLayer[" << (1 + index) << "]/@numberOfNeurons)");
-  return pmml_->getXPathQueryScalar(query);
+  return index < layers_.size() ? layers_[index].numberOfNeurons_ : 0;
 }
 
 /** Get variable name associated to <NeuralInput> with given id attribute */
 String PMMLNeuralNetwork::getNeuralInputName(UnsignedInteger id) const
 {
-  setXPathContext();
-  String query(OSS() << "./" << pmml_->xpathNsPrefix_ << "NeuralInputs/" << "NeuralInput[@id=" << id << "]/*/*/@field");
-  return pmml_->getXPathQueryString(query);
+  for (UnsignedInteger i = 0; i < inputIds_.getSize(); ++i)
+    if (inputIds_[i] == id)
+      return inputNames_[i];
+  return String();
+}
+
+/** Get variable names of <NeuralInput> elements, in document order */
+Description PMMLNeuralNetwork::getNeuralInputNames() const
+{
+  return inputNames_;
+}
+
+/** Get variable names of <NeuralOutput> elements, in document order */
+Description PMMLNeuralNetwork::getNeuralOutputNames() const
+{
+  return outputNames_;
+}
+
+/** Whether neurons of layers have been skipped */
+Bool PMMLNeuralNetwork::isHeaderOnly() const
+{
+  return headerOnly_;
 }
 
 /** Get bias of neurons in the given layer */
 Point PMMLNeuralNetwork::getBiasAtLayer(UnsignedInteger layerIndex) const
 {
-  Point result(getLayerSize(layerIndex));
-  setXPathContext();
-  String query(OSS() << "./" << pmml_->xpathNsPrefix_ << "NeuralLayer[" << (1 + layerIndex) << "]/" << pmml_->xpathNsPrefix_ << "Neuron/@bias");
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST query.c_str(), pmml_->xpathContext_);
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval) && static_cast<UnsignedInteger>(xpathObj->nodesetval->nodeNr) == result.getDimension())
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      result[cnt] = strtod(reinterpret_cast<const char*>(xpathObj->nodesetval->nodeTab[cnt]->children->content), NULL);
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-  return result;
+  return layerIndex < layers_.size() ? layers_[layerIndex].bias_ : Point();
 }
 
 /** Get weights of neurons in the given layer; dimensions are size(layerIndex-1) x size(layerIndex) */
 Matrix PMMLNeuralNetwork::getWeightsAtLayer(UnsignedInteger layerIndex) const
 {
-  UnsignedInteger from, to;
-  Indices fromIndices, toIndices;
-  if (layerIndex == 0)
-  {
-    from = getNumberOfInputs();
-    fromIndices = Indices(from);
-    for (UnsignedInteger i = 0; i < from; ++i)
-      fromIndices[i] = i;
-    to = getLayerSize(0);
-    toIndices = getNeuronIdsAtLayer(0);
-  }
-  else if (layerIndex < getNumberOfLayers())
-  {
-    from = getLayerSize(layerIndex - 1);
-    fromIndices = getNeuronIdsAtLayer(layerIndex - 1);
-    to = getLayerSize(layerIndex);
-    toIndices = getNeuronIdsAtLayer(layerIndex);
-  }
-  else
-  {
-    return Matrix();
-  }
-  if (fromIndices.isEmpty() || toIndices.isEmpty())
-    return Matrix();
-  // Build inverse transformation on indices
-  UnsignedInteger maxFrom(1 + *std::max_element(fromIndices.begin(), fromIndices.end()));
-  Indices invFromIndices(maxFrom);
-  for (UnsignedInteger i = 0; i < from; ++i)
-    invFromIndices[fromIndices[i]] = i;
-  UnsignedInteger maxTo(1 + *std::max_element(toIndices.begin(), toIndices.end()));
-  Indices invToIndices(maxTo);
-  for (UnsignedInteger i = 0; i < to; ++i)
-    invToIndices[toIndices[i]] = i;
-
-  Matrix result(from, to);
-  setXPathContext();
-  String query(OSS() << "./" << pmml_->xpathNsPrefix_ << "NeuralLayer[" << (1 + layerIndex) << "]/" << pmml_->xpathNsPrefix_ << "Neuron");
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST query.c_str(), pmml_->xpathContext_);
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval) && static_cast<UnsignedInteger>(xpathObj->nodesetval->nodeNr) == to)
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      // Get neuron id
-      UnsignedInteger toId(0);
-      for (xmlAttr *cur_attr = xpathObj->nodesetval->nodeTab[cnt]->properties;
-           cur_attr != NULL; cur_attr = cur_attr->next)
-      {
-        if (cur_attr->type == XML_ATTRIBUTE_NODE && 0 == xmlStrcmp(cur_attr->name, BAD_CAST "id"))
-        {
-          toId = strtol(reinterpret_cast<const char*>(cur_attr->children->content), NULL, 10);
-          break;
-        }
-      }
-      toId = invToIndices[toId];
-      // Get connections
-      for (xmlNode *cur_node = xpathObj->nodesetval->nodeTab[cnt]->children; cur_node != NULL; cur_node = cur_node->next)
-      {
-        if (cur_node->type == XML_ELEMENT_NODE && 0 == xmlStrcmp(cur_node->name, BAD_CAST "Con"))
-        {
-          UnsignedInteger countAttributes(0);
-          UnsignedInteger fromId(0);
-          Scalar weight(0.0);
-          for (xmlAttr *cur_attr = cur_node->properties;
-               cur_attr != NULL; cur_attr = cur_attr->next)
-          {
-            if (cur_attr->type != XML_ATTRIBUTE_NODE) continue;
-            if (0 == xmlStrcmp(cur_attr->name, BAD_CAST "from"))
-            {
-              fromId = strtol(reinterpret_cast<const char*>(cur_attr->children->content), NULL, 10);
-              ++ countAttributes;
-            }
-            else if (0 == xmlStrcmp(cur_attr->name, BAD_CAST "weight"))
-            {
-              weight = strtod(reinterpret_cast<const char*>(cur_attr->children->content), NULL);
-              ++ countAttributes;
-            }
-          }
-          if (countAttributes != 2) continue;
-          fromId = invFromIndices[fromId];
-          result(fromId, toId) = weight;
-        }
-      }
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-  return result;
+  return layerIndex < layers_.size() ? layers_[layerIndex].weights_ : Matrix();
 }
 
 /** Get activation function name of the given layer */
 String PMMLNeuralNetwork::getActivationFunctionAtLayer(UnsignedInteger layerIndex) const
 {
-  setXPathContext();
-  String query(OSS() << "./" << pmml_->xpathNsPrefix_ << "NeuralLayer[" << (1 + layerIndex) << "]/@activationFunction");
-  return pmml_->getXPathQueryString(query);
+  return layerIndex < layers_.size() ? layers_[layerIndex].activationFunction_ : String();
 }
 
 /** Retrieve neuron ids of a given neural layer */
 Indices PMMLNeuralNetwork::getNeuronIdsAtLayer(UnsignedInteger layerIndex) const
 {
-  Indices result;
-  UnsignedInteger numberOfNeurons(getLayerSize(layerIndex));
-  std::vector<UnsignedInteger> ids(numberOfNeurons);
-  setXPathContext();
-  String query(OSS() << "./" << pmml_->xpathNsPrefix_ << "NeuralLayer[" << (1 + layerIndex) << "]/" << pmml_->xpathNsPrefix_ << "Neuron/@id");
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST query.c_str(), pmml_->xpathContext_);
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval) && static_cast<UnsignedInteger>(xpathObj->nodesetval->nodeNr) == numberOfNeurons)
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      UnsignedInteger id = strtol(reinterpret_cast<const char*>(xpathObj->nodesetval->nodeTab[cnt]->children->content), NULL, 10);
-      result.add(id);
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-  return result;
+  return layerIndex < layers_.size() ? layers_[layerIndex].neuronIds_ : Indices();
 }
 
 /** Get coefficients needed to normalize inputs */
 Sample PMMLNeuralNetwork::getInputsNormalization() const
 {
-  const UnsignedInteger nrInputs(getNumberOfInputs());
-  Sample result(nrInputs, 4);
-  Description description(4);
-  description[0] = "orig0";
-  description[1] = "orig1";
-  description[2] = "norm0";
-  description[3] = "norm1";
-  result.setDescription(description);
-
-  setXPathContext();
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST (String("./") + pmml_->xpathNsPrefix_ + String("NeuralInputs/") + pmml_->xpathNsPrefix_ + String("NeuralInput/") + pmml_->xpathNsPrefix_ + String("DerivedField/") + pmml_->xpathNsPrefix_ + String("NormContinuous/") + pmml_->xpathNsPrefix_ + String("LinearNorm/@orig")).c_str(), pmml_->xpathContext_);
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval) && static_cast<UnsignedInteger>(xpathObj->nodesetval->nodeNr) == 2 * nrInputs)
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      result(cnt / 2, cnt & 1) = strtod(reinterpret_cast<const char*>(xpathObj->nodesetval->nodeTab[cnt]->children->content), NULL);
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-  setXPathContext();
-  xpathObj = xmlXPathEvalExpression(BAD_CAST (String("./") + pmml_->xpathNsPrefix_ + String("NeuralInputs/") + pmml_->xpathNsPrefix_ + String("NeuralInput/") + pmml_->xpathNsPrefix_ + String("DerivedField/") + pmml_->xpathNsPrefix_ + String("NormContinuous/") + pmml_->xpathNsPrefix_ + String("LinearNorm/@norm")).c_str(), pmml_->xpathContext_);
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval) && static_cast<UnsignedInteger>(xpathObj->nodesetval->nodeNr) == 2 * nrInputs)
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      result(cnt / 2, 2 + (cnt & 1)) = strtod(reinterpret_cast<const char*>(xpathObj->nodesetval->nodeTab[cnt]->children->content), NULL);
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-
   // Check that all normalizations are consistent
-  UnsignedInteger normalizationType = 0;
-  for (UnsignedInteger i = 0; i < result.getSize(); ++i)
-  {
-    UnsignedInteger currentNormType(0);
-    if (result(i, 0) == 0.0 && result(i, 3) == 0.0)
-    {
-      // Case 1:
-      //   orig0 = 0;
-      //   orig1 = dmin;
-      //   norm0 = -dmax/dmin;
-      //   norm1 = 0;
-      currentNormType = 1;
-    }
-    else if (result(i, 2) == -1.0 && result(i, 3) == 1.0)
-    {
-      // Case 2:
-      //   orig0 = dmin;
-      //   orig1 = dmax;
-      //   norm0 = -1;
-      //   norm1 = 1;
-      currentNormType = 2;
-    }
-    else
-    {
-      LOGWARN("Unknown method for inputs normalization, results may be wrong");
-      break;
-    }
-    if (normalizationType != 0 && normalizationType != currentNormType)
-    {
-      LOGWARN("Unknown method for inputs normalization, results may be wrong");
-      break;
-    }
-    normalizationType = currentNormType;
-  }
-
-  return result;
+  if (GetNormalizationType(inputsNormalization_) == 0)
+    LOGWARN("Unknown method for inputs normalization, results may be wrong");
+  return inputsNormalization_;
 }
 
 /** Get coefficients needed to normalize outputs */
 Sample PMMLNeuralNetwork::getOutputsNormalization() const
 {
-  const UnsignedInteger nrOutputs(getNumberOfOutputs());
-  Sample result(nrOutputs, 4);
-  Description description(4);
-  description[0] = "orig0";
-  description[1] = "orig1";
-  description[2] = "norm0";
-  description[3] = "norm1";
-  result.setDescription(description);
-
-  setXPathContext();
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST (String("./") + pmml_->xpathNsPrefix_ + String("NeuralOutputs/") + pmml_->xpathNsPrefix_ + String("NeuralOutput/") + pmml_->xpathNsPrefix_ + String("DerivedField/") + pmml_->xpathNsPrefix_ + String("NormContinuous/") + pmml_->xpathNsPrefix_ + String("LinearNorm/@orig")).c_str(), pmml_->xpathContext_);
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval) && static_cast<UnsignedInteger>(xpathObj->nodesetval->nodeNr) == 2 * nrOutputs)
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      result(cnt / 2, cnt & 1) = strtod(reinterpret_cast<const char*>(xpathObj->nodesetval->nodeTab[cnt]->children->content), NULL);
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-  setXPathContext();
-  xpathObj = xmlXPathEvalExpression(BAD_CAST (String("./") + pmml_->xpathNsPrefix_ + String("NeuralOutputs/") + pmml_->xpathNsPrefix_ + String("NeuralOutput/") + pmml_->xpathNsPrefix_ + String("DerivedField/") + pmml_->xpathNsPrefix_ + String("NormContinuous/") + pmml_->xpathNsPrefix_ + String("LinearNorm/@norm")).c_str(), pmml_->xpathContext_);
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval) && static_cast<UnsignedInteger>(xpathObj->nodesetval->nodeNr) == 2 * nrOutputs)
-  {
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
-    {
-      result(cnt / 2, 2 + (cnt & 1)) = strtod(reinterpret_cast<const char*>(xpathObj->nodesetval->nodeTab[cnt]->children->content), NULL);
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
-
   // Check that all normalizations are consistent
+  if (GetNormalizationType(outputsNormalization_) == 0)
+    LOGWARN("Unknown method for outputs normalization, results may be wrong");
+  return outputsNormalization_;
+}
+
+/** Get normalization type of coefficients returned by getInputsNormalization or getOutputsNormalization */
+UnsignedInteger PMMLNeuralNetwork::GetNormalizationType(const Sample & normalization)
+{
   UnsignedInteger normalizationType = 0;
-  for (UnsignedInteger i = 0; i < result.getSize(); ++i)
+  for (UnsignedInteger i = 0; i < normalization.getSize(); ++i)
   {
     UnsignedInteger currentNormType(0);
-    if (result(i, 0) == 0.0 && result(i, 3) == 0.0)
+    if (normalization(i, 0) == 0.0 && normalization(i, 3) == 0.0)
     {
       // Case 1:
       //   orig0 = 0;
@@ -352,7 +499,7 @@ Sample PMMLNeuralNetwork::getOutputsNormalization() const
       //   norm1 = 0;
       currentNormType = 1;
     }
-    else if (result(i, 2) == -1.0 && result(i, 3) == 1.0)
+    else if (normalization(i, 2) == -1.0 && normalization(i, 3) == 1.0)
     {
       // Case 2:
       //   orig0 = dmin;
@@ -362,20 +509,12 @@ Sample PMMLNeuralNetwork::getOutputsNormalization() const
       currentNormType = 2;
     }
     else
-    {
-      LOGWARN("Unknown method for outputs normalization, results may be wrong");
-      break;
-    }
+      return 0;
     if (normalizationType != 0 && normalizationType != currentNormType)
-    {
-      LOGWARN("Unknown method for outputs normalization, results may be wrong");
-      break;
-    }
+      return 0;
     normalizationType = currentNormType;
   }
-
-
-  return result;
+  return normalizationType;
 }
 
 /** Get input normalization as a Function */
@@ -470,21 +609,21 @@ Function PMMLNeuralNetwork::getOutputsNormalizationFunction() const
 /** Get evaluation function of a given layer as a Function */
 Function PMMLNeuralNetwork::getEvaluationFunctionAtLayer(UnsignedInteger layerIndex) const
 {
-  // See http://www.dmg.org/v3-0/Transformations.html
-  const Sample input(getInputsNormalization());
   const UnsignedInteger size(getLayerSize(layerIndex));
   if (size == 0) return Function();
+  return BuildLayerFunction(getWeightsAtLayer(layerIndex), getBiasAtLayer(layerIndex), getActivationFunctionAtLayer(layerIndex));
+}
 
-  String activation(getActivationFunctionAtLayer(layerIndex));
-
-  const Point bias(getBiasAtLayer(layerIndex));
-  const Matrix weights(getWeightsAtLayer(layerIndex));
-
-  UnsignedInteger prevSize;
-  if (layerIndex == 0)
-    prevSize = getNumberOfInputs();
-  else
-    prevSize = getLayerSize(layerIndex - 1);
+/** Build evaluation function of a layer from its coefficients; outputs are denormalized if outputScale is not empty */
+Function PMMLNeuralNetwork::BuildLayerFunction(const Matrix & weights,
+    const Point & bias,
+    const String & activation,
+    const Point & outputScale,
+    const Point & outputShift)
+{
+  // See http://www.dmg.org/v3-0/Transformations.html
+  const UnsignedInteger size(weights.getNbColumns());
+  const UnsignedInteger prevSize(weights.getNbRows());
 
   Description inputVariablesNames(prevSize);
   for (UnsignedInteger k = 0; k < prevSize; ++k)
@@ -495,11 +634,15 @@ Function PMMLNeuralNetwork::getEvaluationFunctionAtLayer(UnsignedInteger layerIn
   {
     OSS stream;
     stream.setPrecision(20);
+    // Missing connections have a null weight and are skipped
+    Bool first = true;
     for (UnsignedInteger k = 0; k < prevSize; ++k)
     {
-      stream << (weights(k, i) < 0.0 ? "-" : (k == 0 ? "" : "+")) << std::abs(weights(k, i)) << "*x" << k;
+      if (weights(k, i) == 0.0) continue;
+      stream << (weights(k, i) < 0.0 ? "-" : (first ? "" : "+")) << std::abs(weights(k, i)) << "*x" << k;
+      first = false;
     }
-    stream << (bias[i] < 0.0 ? "" : "+" ) << bias[i];
+    stream << (bias[i] < 0.0 || first ? "" : "+" ) << bias[i];
     if(activation == "tanh")
       formulas[i] = String("tanh(") + String(stream) + String(")");
     else if(activation == "logistic")
@@ -527,6 +670,8 @@ Function PMMLNeuralNetwork::getEvaluationFunctionAtLayer(UnsignedInteger layerIn
       LOGERROR(OSS() << "Unknown activation function: " << activation);
       formulas[i] = String(stream);
     }
+    if (outputScale.getDimension() > 0)
+      formulas[i] = (OSS().setPrecision(20) << outputShift[i] << "+(" << outputScale[i] << ")*(" << formulas[i] << ")");
   }
   return SymbolicFunction(inputVariablesNames, formulas);
 }
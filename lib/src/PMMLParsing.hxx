@@ -0,0 +1,103 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  PMMLParsing.hxx
+ *  @brief Helpers to read elements and attributes of a PMML document
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+// This file is not a regular header: it is only included by the sources which
+// read PMML models, either from a DOM tree or from an xmlTextReader stream.
+// Element names are compared without their namespace prefix.
+
+#ifndef OTPMML_PMMLPARSING_HXX
+#define OTPMML_PMMLPARSING_HXX
+
+#include <openturns/OTprivate.hxx>
+
+#include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+
+#include "NumberParsing.hxx"
+
+namespace OTPMML
+{
+
+/* Whether a node is an element with the given name */
+inline OT::Bool IsElement(const xmlNode * node, const char * name)
+{
+  return node->type == XML_ELEMENT_NODE && 0 == xmlStrcmp(node->name, BAD_CAST name);
+}
+
+/* Value of an attribute of an element, NULL if it is missing */
+inline const char * GetAttribute(const xmlNode * node, const char * name)
+{
+  for (xmlAttr * cur_attr = node->properties; cur_attr != NULL; cur_attr = cur_attr->next)
+  {
+    if (cur_attr->type == XML_ATTRIBUTE_NODE && 0 == xmlStrcmp(cur_attr->name, BAD_CAST name) && cur_attr->children != NULL)
+      return reinterpret_cast<const char*>(cur_attr->children->content);
+  }
+  return NULL;
+}
+
+/* Value of a numerical attribute, 0 if it is missing; malformed values are errors */
+inline OT::Scalar GetScalarAttribute(const xmlNode * node, const char * name)
+{
+  const char * value = GetAttribute(node, name);
+  return value ? ToScalar(value, name) : 0.0;
+}
+
+inline OT::UnsignedInteger GetIntegerAttribute(const xmlNode * node, const char * name)
+{
+  const char * value = GetAttribute(node, name);
+  return value ? ToUnsignedInteger(value, name) : 0;
+}
+
+/* Whether the current node of a reader is the start of an element with the given name */
+inline OT::Bool IsElement(xmlTextReaderPtr reader, const char * name)
+{
+  return xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT && 0 == xmlStrcmp(xmlTextReaderConstLocalName(reader), BAD_CAST name);
+}
+
+/* Value of an attribute of the current element of a reader, NULL if it is missing;
+   it is only valid until the reader is moved */
+inline const char * GetAttribute(xmlTextReaderPtr reader, const char * name)
+{
+  if (xmlTextReaderMoveToAttribute(reader, BAD_CAST name) != 1)
+    return NULL;
+  const char * value = reinterpret_cast<const char*>(xmlTextReaderConstValue(reader));
+  xmlTextReaderMoveToElement(reader);
+  return value;
+}
+
+/* Value of a numerical attribute, 0 if it is missing; malformed values are errors */
+inline OT::Scalar GetScalarAttribute(xmlTextReaderPtr reader, const char * name)
+{
+  const char * value = GetAttribute(reader, name);
+  return value ? ToScalar(value, name) : 0.0;
+}
+
+inline OT::UnsignedInteger GetIntegerAttribute(xmlTextReaderPtr reader, const char * name)
+{
+  const char * value = GetAttribute(reader, name);
+  return value ? ToUnsignedInteger(value, name) : 0;
+}
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_PMMLPARSING_HXX */
@@ -21,16 +21,11 @@
  */
 #include "otpmml/PMMLRegressionModel.hxx"
 #include "otpmml/PMMLDoc.hxx"
+#include "PMMLParsing.hxx"
 
 #include <openturns/Exception.hxx>
 
-#include <libxml/parser.h>
-#include <libxml/xpath.h>
-#include <libxml/xpathInternals.h>
-
-#include <iostream>
 #include <cstring>
-#include <cstdlib>
 
 using namespace OT;
 
@@ -39,160 +34,209 @@ namespace OTPMML
 
 /* Default constructor */
 PMMLRegressionModel::PMMLRegressionModel(const PMMLDoc * pmml, const String & modelName, const xmlNodePtr & node)
-  : pmml_(pmml)
-  , modelName_(modelName)
-  , node_(node)
-  , validated_(false)
+  : modelName_(modelName)
+  , intercept_(0.0)
 {
+  pmml->checkInitialized();
+  readModel(node);
 }
 
-/** Get model name */
-String PMMLRegressionModel::getModelName() const
+/* Constructor from a reader positioned on a <RegressionModel> element */
+PMMLRegressionModel::PMMLRegressionModel(const String & modelName, xmlTextReaderPtr reader)
+  : modelName_(modelName)
+  , intercept_(0.0)
 {
-  return modelName_;
+  readModel(reader);
 }
 
-/** Set XPath context to node_ */
-void PMMLRegressionModel::setXPathContext() const
+/** Get model name */
+String PMMLRegressionModel::getModelName() const
 {
-  pmml_->checkInitialized();
-  pmml_->xpathContext_->node = node_;
+  return modelName_;
 }
 
 /** Get intercept */
 Scalar PMMLRegressionModel::getIntercept() const
 {
-  setXPathContext();
   checkValid();
-  return pmml_->getXPathQueryScalar(String("number(./") + pmml_->xpathNsPrefix_ + String("RegressionTable/@intercept)"));
+  return intercept_;
 }
 
 /** Get name of target variable */
 String PMMLRegressionModel::getTargetVariableName() const
 {
-  setXPathContext();
   checkValid();
-  return pmml_->getXPathQueryString("./@targetFieldName");
+  return targetVariableName_;
 }
 
 /** Get coefficients */
 Sample PMMLRegressionModel::getCoefficients() const
 {
-  setXPathContext();
   checkValid();
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST (String("./") + pmml_->xpathNsPrefix_ + String("RegressionTable/") + pmml_->xpathNsPrefix_ + String("NumericPredictor")).c_str(), pmml_->xpathContext_);
-  Sample result;
-  if(!xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
+  return coefficients_;
+}
+
+/** Fill the model by walking once the <RegressionModel> element */
+void PMMLRegressionModel::readModel(const xmlNodePtr & node)
+{
+  if (node == NULL) return;
+  const char * targetFieldName = GetAttribute(node, "targetFieldName");
+  targetVariableName_ = targetFieldName ? targetFieldName : "";
+  error_ = CheckModelAttributes(GetAttribute(node, "modelType"), GetAttribute(node, "functionName"), GetAttribute(node, "normalizationMethod"));
+
+  UnsignedInteger numberOfTables = 0;
+  Description names;
+  Point coefficients;
+  Bool hasExponent = false;
+  String elementError;
+  String exponentError;
+  for (const xmlNode * table = node->children; table != NULL; table = table->next)
   {
-    Collection<String> names;
-    Collection<Scalar> coefficients;
-    for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
+    if (!IsElement(table, "RegressionTable")) continue;
+    ++numberOfTables;
+    if (numberOfTables > 1) continue;
+    intercept_ = GetScalarAttribute(table, "intercept");
+    for (const xmlNode * predictor = table->children; predictor != NULL; predictor = predictor->next)
     {
-      for (xmlAttr *cur_attr = xpathObj->nodesetval->nodeTab[cnt]->properties;
-           cur_attr != NULL; cur_attr = cur_attr->next)
-      {
-        if (cur_attr->type != XML_ATTRIBUTE_NODE) continue;
-        if (0 == xmlStrcmp(cur_attr->name, BAD_CAST "name"))
-        {
-          names.add(String(reinterpret_cast<const char*>(cur_attr->children->content)));
-        }
-        else if (0 == xmlStrcmp(cur_attr->name, BAD_CAST "coefficient"))
-        {
-          coefficients.add(strtod(reinterpret_cast<const char*>(cur_attr->children->content), NULL));
-        }
-      }
+      if (predictor->type != XML_ELEMENT_NODE) continue;
+      if (elementError.empty())
+        elementError = CheckPredictorElement(predictor->name);
+      if (!IsElement(predictor, "NumericPredictor")) continue;
+      const char * exponent = GetAttribute(predictor, "exponent");
+      hasExponent = hasExponent || exponent;
+      if (exponentError.empty())
+        exponentError = CheckPredictorExponent(exponent);
+      const char * name = GetAttribute(predictor, "name");
+      if (name)
+        names.add(name);
+      if (GetAttribute(predictor, "coefficient"))
+        coefficients.add(GetScalarAttribute(predictor, "coefficient"));
     }
-    result = Sample(1, Point(coefficients));
-    result.setDescription(names);
   }
-  xmlXPathFreeObject(xpathObj);
-  return result;
+  setRegressionTable(numberOfTables, names, coefficients, hasExponent, elementError, exponentError);
 }
 
-/** Checks that this is a linearRegression model */
-void PMMLRegressionModel::checkValid() const
+/** Fill the model by reading once the <RegressionModel> element */
+void PMMLRegressionModel::readModel(xmlTextReaderPtr reader)
 {
-  if (validated_) return;
-
-  // Check regression type
-  for (xmlAttr *cur_attr = node_->properties;
-       cur_attr != NULL; cur_attr = cur_attr->next)
+  const char * attribute = GetAttribute(reader, "targetFieldName");
+  targetVariableName_ = attribute ? attribute : "";
+  // Attribute values are only valid until the reader is moved
+  attribute = GetAttribute(reader, "modelType");
+  const String modelType(attribute ? attribute : "");
+  const Bool hasModelType = attribute != NULL;
+  attribute = GetAttribute(reader, "functionName");
+  const String functionName(attribute ? attribute : "");
+  const Bool hasFunctionName = attribute != NULL;
+  attribute = GetAttribute(reader, "normalizationMethod");
+  const String normalizationMethod(attribute ? attribute : "");
+  const Bool hasNormalizationMethod = attribute != NULL;
+  error_ = CheckModelAttributes(hasModelType ? modelType.c_str() : NULL,
+                                hasFunctionName ? functionName.c_str() : NULL,
+                                hasNormalizationMethod ? normalizationMethod.c_str() : NULL);
+
+  UnsignedInteger numberOfTables = 0;
+  Description names;
+  Point coefficients;
+  Bool hasExponent = false;
+  String elementError;
+  String exponentError;
+  const int depth = xmlTextReaderDepth(reader);
+  int status = 1;
+  while ((status = xmlTextReaderRead(reader)) == 1)
   {
-    if (cur_attr->type != XML_ATTRIBUTE_NODE) continue;
-    if (0 == xmlStrcmp(cur_attr->name, BAD_CAST "modelType"))
-    {
-      const char* modelType = reinterpret_cast<const char*>(cur_attr->children->content);
-      if (0 != strcmp(modelType, "linearRegression"))
-        throw InvalidArgumentException(HERE) << "RegressionModel found with modelType='" << modelType << "', but only 'linearRegression' is supported";
-      break;
-    }
-    if (0 == xmlStrcmp(cur_attr->name, BAD_CAST "functionName"))
+    const int level = xmlTextReaderDepth(reader) - depth;
+    if (level <= 0) break;
+    if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) continue;
+    if (level == 1)
     {
-      const char* functionName = reinterpret_cast<const char*>(cur_attr->children->content);
-      if (0 != strcmp(functionName, "regression"))
-        throw InvalidArgumentException(HERE) << "RegressionModel found with functionName='" << functionName << "', but only 'regression' is supported";
-      break;
+      if (!IsElement(reader, "RegressionTable")) continue;
+      ++numberOfTables;
+      if (numberOfTables == 1)
+        intercept_ = GetScalarAttribute(reader, "intercept");
     }
-    if (0 == xmlStrcmp(cur_attr->name, BAD_CAST "normalizationMethod"))
+    else if (level == 2 && numberOfTables == 1)
     {
-      const char* normalizationMethod = reinterpret_cast<const char*>(cur_attr->children->content);
-      if (0 != strcmp(normalizationMethod, "none"))
-        throw InvalidArgumentException(HERE) << "RegressionModel found with normalizationMethod='" << normalizationMethod << "', but only 'none' is supported";
-      break;
+      if (elementError.empty())
+        elementError = CheckPredictorElement(xmlTextReaderConstLocalName(reader));
+      if (!IsElement(reader, "NumericPredictor")) continue;
+      const char * exponent = GetAttribute(reader, "exponent");
+      hasExponent = hasExponent || exponent;
+      if (exponentError.empty())
+        exponentError = CheckPredictorExponent(exponent);
+      const char * name = GetAttribute(reader, "name");
+      if (name)
+        names.add(name);
+      if (GetAttribute(reader, "coefficient"))
+        coefficients.add(GetScalarAttribute(reader, "coefficient"));
     }
   }
+  if (status == -1)
+    throw InvalidArgumentException(HERE) << "Unable to read <RegressionModel> element named '" << modelName_ << "'";
+  setRegressionTable(numberOfTables, names, coefficients, hasExponent, elementError, exponentError);
+}
 
-  setXPathContext();
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression(BAD_CAST (String("./") + pmml_->xpathNsPrefix_ + String("RegressionTable")).c_str(), pmml_->xpathContext_);
-  if(xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
-  {
-    xmlXPathFreeObject(xpathObj);
-    throw InvalidArgumentException(HERE) << "No <RegressionTable> element found";
-  }
-  if(xpathObj->nodesetval->nodeNr != 1)
-  {
-    const UnsignedInteger nr(xpathObj->nodesetval->nodeNr);
-    xmlXPathFreeObject(xpathObj);
-    throw InvalidArgumentException(HERE) << nr << "  <RegressionTable> elements found, but there must be only one";
-  }
-  for (xmlNode *cur_node = xpathObj->nodesetval->nodeTab[0]->children;
-       cur_node != NULL; cur_node = cur_node->next)
-  {
-    if (cur_node->type != XML_ELEMENT_NODE) continue;
-    if (0 != xmlStrcmp(cur_node->name, BAD_CAST "NumericPredictor"))
-    {
-      const String name(reinterpret_cast<const char*>(cur_node->name));
-      xmlXPathFreeObject(xpathObj);
-      throw InvalidArgumentException(HERE) << "Element <" << name << "> found, but only <NumericPredictor> is supported";
-    }
-  }
-  xmlXPathFreeObject(xpathObj);
+/** Error message for unsupported attributes of <RegressionModel>, empty if they are supported */
+String PMMLRegressionModel::CheckModelAttributes(const char * modelType, const char * functionName, const char * normalizationMethod)
+{
+  if (modelType && 0 != strcmp(modelType, "linearRegression"))
+    return OSS() << "RegressionModel found with modelType='" << modelType << "', but only 'linearRegression' is supported";
+  if (functionName && 0 != strcmp(functionName, "regression"))
+    return OSS() << "RegressionModel found with functionName='" << functionName << "', but only 'regression' is supported";
+  if (normalizationMethod && 0 != strcmp(normalizationMethod, "none"))
+    return OSS() << "RegressionModel found with normalizationMethod='" << normalizationMethod << "', but only 'none' is supported";
+  return String();
+}
 
-  setXPathContext();
-  xpathObj = xmlXPathEvalExpression(BAD_CAST (String("./") + pmml_->xpathNsPrefix_ + String("RegressionTable/") + pmml_->xpathNsPrefix_ + String("NumericPredictor/@exponent")).c_str(), pmml_->xpathContext_);
-  if(xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
-  {
-    xmlXPathFreeObject(xpathObj);
-    throw InvalidArgumentException(HERE) << "Internal error, exponent attributes are not found";
-  }
+/** Error message for an unsupported child of <RegressionTable>, empty if it is supported */
+String PMMLRegressionModel::CheckPredictorElement(const xmlChar * name)
+{
+  if (0 != xmlStrcmp(name, BAD_CAST "NumericPredictor"))
+    return OSS() << "Element <" << reinterpret_cast<const char*>(name) << "> found, but only <NumericPredictor> is supported";
+  return String();
+}
 
-  for (int cnt = 0; cnt < xpathObj->nodesetval->nodeNr; ++cnt)
+/** Error message for an unsupported exponent attribute, empty if it is supported */
+String PMMLRegressionModel::CheckPredictorExponent(const char * exponent)
+{
+  if (exponent == NULL) return String();
+  if (1.0 != ToScalar(exponent, "exponent"))
+    return OSS() << "Exponent " << exponent << " found, but only exponent=1 is supported";
+  return String();
+}
+
+/** Store the contents of the <RegressionTable> element, and the first unsupported feature */
+void PMMLRegressionModel::setRegressionTable(const UnsignedInteger numberOfTables,
+    const Description & names,
+    const Point & coefficients,
+    const Bool hasExponent,
+    const String & elementError,
+    const String & exponentError)
+{
+  if (coefficients.getDimension() > 0 || names.getSize() > 0)
   {
-    xmlNode *cur_node = xpathObj->nodesetval->nodeTab[cnt];
-    if (cur_node->type != XML_ATTRIBUTE_NODE) continue;
-    if (0 == xmlStrcmp(cur_node->name, BAD_CAST "exponent"))
-    {
-      UnsignedInteger exponent(strtol(reinterpret_cast<const char*>(cur_node->children->content), NULL, 10));
-      if (1 != exponent)
-      {
-        xmlXPathFreeObject(xpathObj);
-        throw InvalidArgumentException(HERE) << "Exponent " << exponent << " found, but only exponent=1 is supported";
-      }
-    }
+    coefficients_ = Sample(1, coefficients);
+    if (names.getSize() == coefficients.getDimension())
+      coefficients_.setDescription(names);
   }
-  xmlXPathFreeObject(xpathObj);
+  if (!error_.empty()) return;
+  if (numberOfTables == 0)
+    error_ = "No <RegressionTable> element found";
+  else if (numberOfTables != 1)
+    error_ = OSS() << numberOfTables << "  <RegressionTable> elements found, but there must be only one";
+  else if (!elementError.empty())
+    error_ = elementError;
+  else if (!hasExponent)
+    error_ = "Internal error, exponent attributes are not found";
+  else
+    error_ = exponentError;
+}
 
-  validated_ = true;
+/** Checks that this is a linearRegression model */
+void PMMLRegressionModel::checkValid() const
+{
+  if (!error_.empty())
+    throw InvalidArgumentException(HERE) << error_;
 }
 
 } /* namespace OTPMML */
@@ -0,0 +1,83 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ParallelTasks.hxx
+ *  @brief Run independent tasks on a few threads
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+
+// This file is not a regular header: it is only included by the sources which
+// split their work over threads, it is not installed.
+
+#ifndef OTPMML_PARALLELTASKS_HXX
+#define OTPMML_PARALLELTASKS_HXX
+
+#include <openturns/OTprivate.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace OTPMML
+{
+
+/* Number of threads to use, 0 meaning all hardware threads */
+inline OT::UnsignedInteger GetNumberOfThreads(const OT::UnsignedInteger numberOfThreads)
+{
+  if (numberOfThreads != 0) return numberOfThreads;
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+/* Run task(i) for each i < size on numberOfThreads threads, the calling thread being one of them;
+   each thread picks the next task until all tasks are done.  Errors do not stop the other tasks,
+   they are rethrown once all threads are joined, in the order of the tasks */
+template <class Task>
+void RunTasks(const OT::UnsignedInteger size, const OT::UnsignedInteger numberOfThreads, const Task & task)
+{
+  std::vector<std::exception_ptr> errors(size);
+  std::atomic<OT::UnsignedInteger> nextTask(0);
+  const auto run = [&]()
+  {
+    for (OT::UnsignedInteger i = nextTask++; i < size; i = nextTask++)
+    {
+      try
+      {
+        task(i);
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (OT::UnsignedInteger i = 1; i < std::min(numberOfThreads, size); ++i)
+    threads.push_back(std::thread(run));
+  run();
+  for (OT::UnsignedInteger i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  for (OT::UnsignedInteger i = 0; i < size; ++i)
+    if (errors[i])
+      std::rethrow_exception(errors[i]);
+}
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_PARALLELTASKS_HXX */
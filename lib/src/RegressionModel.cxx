@@ -22,9 +22,9 @@
  */
 #include "otpmml/RegressionModel.hxx"
 #include "otpmml/PMMLDoc.hxx"
+#include "otpmml/ModelRegistry.hxx"
 #include "otpmml/PMMLRegressionModel.hxx"
-
-#include <libxml/parser.h>
+#include "LoadRecorder.hxx"
 
 using namespace OT;
 
@@ -33,11 +33,47 @@ namespace OTPMML
 
 /* Default constructor */
 RegressionModel::RegressionModel(const FileName & pmmlFile, const OT::String& modelName)
+  : RegressionModel(PMMLBuffer::MapFile(pmmlFile), modelName)
+{
+  // Nothing to do
+}
+
+/* Constructor from a buffer */
+RegressionModel::RegressionModel(const PMMLBuffer & buffer, const OT::String& modelName)
   : PersistentObject()
 {
-  xmlInitParser();
-  PMMLDoc doc(pmmlFile);
-  PMMLRegressionModel model(doc.getRegressionModel(modelName));
+  // A model already built from the same file is shared, models read from memory are not registered
+  LoadRecorder recorder("RegressionModel", modelName);
+  const String key(buffer.getFileName().empty() ? String() : ModelRegistry::GetKey(buffer.getFileName(), "RegressionModel", modelName));
+  if (ModelRegistry::FindRegressionModel(key, metamodel_)) return;
+  {
+    const PMMLRegressionModel model(PMMLDoc::StreamRegressionModel(buffer, modelName));
+    LoadRecorder::StartPhase(LoadProfile::BUILD);
+    metamodel_ = BuildLinearLeastSquares(model);
+    LoadRecorder::StartPhase(LoadProfile::CLEANUP);
+  }
+  LoadRecorder::StartPhase(LoadProfile::BUILD);
+  ModelRegistry::AddRegressionModel(key, metamodel_);
+}
+
+RegressionModel::RegressionModel(const LinearLeastSquares & implementation)
+  : PersistentObject()
+  , metamodel_(new LinearLeastSquares(implementation))
+{
+  // Nothing to do
+}
+
+/* Constructor from a model built by BuildLinearLeastSquares */
+RegressionModel::RegressionModel(const Pointer<LinearLeastSquares> & metamodel)
+  : PersistentObject()
+  , metamodel_(metamodel)
+{
+  // Nothing to do
+}
+
+/* Build the LinearLeastSquares of a model */
+Pointer<LinearLeastSquares> RegressionModel::BuildLinearLeastSquares(const PMMLRegressionModel & model)
+{
   const Sample coefficients(model.getCoefficients());
   const Scalar intercept(model.getIntercept());
   // There is no LinearLeastSquares constructor with explicit
@@ -54,17 +90,10 @@ RegressionModel::RegressionModel(const FileName & pmmlFile, const OT::String& mo
   outputSample(dimension, 0) = intercept;
   inputSample.setDescription(coefficients.getDescription());
   outputSample.setDescription(Description(1, model.getTargetVariableName()));
-  metamodel_ = new LinearLeastSquares(inputSample, outputSample);
-  metamodel_->setName(model.getModelName());
-  metamodel_->run();
-  xmlCleanupParser();
-}
-
-RegressionModel::RegressionModel(const LinearLeastSquares & implementation)
-  : PersistentObject()
-  , metamodel_(new LinearLeastSquares(implementation))
-{
-  // Nothing to do
+  Pointer<LinearLeastSquares> metamodel(new LinearLeastSquares(inputSample, outputSample));
+  metamodel->setName(model.getModelName());
+  metamodel->run();
+  return metamodel;
 }
 
 /* Virtual constructor method */
@@ -92,14 +121,12 @@ LinearLeastSquares RegressionModel::getLinearLeastSquares() const
 /** Export linear regression into a .pmml file */
 void RegressionModel::exportToPMMLFile(const FileName & pmmlFile) const
 {
-  xmlInitParser();
   PMMLDoc doc;
   String modelName(metamodel_->getName());
   if (modelName.empty())
     modelName = "Unnamed";
   doc.addRegressionModel(modelName, *metamodel_);
   doc.write(pmmlFile);
-  xmlCleanupParser();
 }
 
 /* Method save() stores the object through the StorageManager */
@@ -113,7 +140,10 @@ void RegressionModel::save(Advocate & adv) const
 void RegressionModel::load(Advocate & adv)
 {
   PersistentObject::load( adv );
-  adv.loadAttribute( "metamodel_", *metamodel_ );
+  // The model may be shared with other instances
+  LinearLeastSquares metamodel(*metamodel_);
+  adv.loadAttribute( "metamodel_", metamodel );
+  metamodel_ = new LinearLeastSquares(metamodel);
 }
 
 } /* namespace OTPMML */
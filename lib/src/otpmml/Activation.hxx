@@ -0,0 +1,67 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  Activation.hxx
+ *  @brief Activation functions of PMML neural layers
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_ACTIVATION_HXX
+#define OTPMML_ACTIVATION_HXX
+
+#include <openturns/OTprivate.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class Activation
+ *
+ * Activation gathers the activation functions which can be found in the
+ * activationFunction attribute of a <NeuralLayer> element.
+ */
+class OTPMML_API Activation
+{
+public:
+  enum Type { IDENTITY = 0, TANH, LOGISTIC, EXPONENTIAL, RECIPROCAL, SQUARE, GAUSS, SINE, COSINE, ELLIOTT, ARCTAN };
+
+  /** Get activation type from its PMML name; unknown names are mapped to IDENTITY */
+  static Type GetTypeFromName(const OT::String & name);
+
+  /** Get PMML name of an activation type */
+  static OT::String GetName(const OT::UnsignedInteger type);
+
+  /** Evaluate activation function at a given point */
+  static OT::Scalar Evaluate(const OT::UnsignedInteger type, const OT::Scalar x);
+
+  /** Evaluate activation function in place on an array of values, see ActivationKernels */
+  static void Evaluate(const OT::UnsignedInteger type, OT::Scalar * values, const OT::UnsignedInteger size);
+  static void Evaluate(const OT::UnsignedInteger type, float * values, const OT::UnsignedInteger size);
+
+  /** Evaluate the derivative of an activation function at a given point */
+  static OT::Scalar Derivative(const OT::UnsignedInteger type, const OT::Scalar x);
+
+  /** Evaluate the second derivative of an activation function at a given point */
+  static OT::Scalar SecondDerivative(const OT::UnsignedInteger type, const OT::Scalar x);
+
+}; /* class Activation */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_ACTIVATION_HXX */
@@ -0,0 +1,68 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ActivationKernels.hxx
+ *  @brief Vectorized activation functions of PMML neural layers
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_ACTIVATIONKERNELS_HXX
+#define OTPMML_ACTIVATIONKERNELS_HXX
+
+#include <openturns/OTprivate.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class ActivationKernels
+ *
+ * ActivationKernels evaluates activation functions on whole arrays with SIMD
+ * instructions.  The widest instruction set supported by the processor is
+ * selected at runtime; the SCALAR instruction set calls the functions of
+ * Activation one value at a time, and is the only one available on
+ * processors or compilers for which no vectorized kernel is compiled.
+ * On Windows, only the SSE2 kernels are compiled.
+ */
+class OTPMML_API ActivationKernels
+{
+public:
+  enum InstructionSet { SCALAR = 0, SSE2, AVX2, AVX512 };
+
+  /** Evaluate activation function in place on an array of values */
+  static void Evaluate(const OT::UnsignedInteger type, OT::Scalar * values, const OT::UnsignedInteger size);
+
+  /** Evaluate activation function in place on an array of single precision values */
+  static void Evaluate(const OT::UnsignedInteger type, float * values, const OT::UnsignedInteger size);
+
+  /** Widest instruction set supported by the processor */
+  static InstructionSet GetSupportedInstructionSet();
+
+  /** Instruction set used by Evaluate, the widest supported one by default */
+  static InstructionSet GetInstructionSet();
+  static void SetInstructionSet(const InstructionSet instructionSet);
+
+  /** Name of an instruction set */
+  static OT::String GetInstructionSetName(const OT::UnsignedInteger instructionSet);
+
+}; /* class ActivationKernels */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_ACTIVATIONKERNELS_HXX */
@@ -0,0 +1,74 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  BinaryDAT.hxx
+ *  @brief Utility class to import/export binary columnar DAT files
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_BINARYDAT_HXX
+#define OTPMML_BINARYDAT_HXX
+
+#include "otpmml/OTPMMLprivate.hxx"
+
+#include <openturns/Sample.hxx>
+#include <openturns/Indices.hxx>
+
+namespace OTPMML
+{
+
+/**
+ * @class BinaryDAT
+ *
+ * BinaryDAT is a utility class to import/export the binary companion of .dat
+ * files: a header with the names of the columns and the input and output
+ * dimensions, followed by each column as contiguous, aligned float64 values.
+ * Files are memory-mapped when they are read, so that selected columns are
+ * copied from the mapping into the sample and the other ones are not read.
+ * Files use the byte order of the machine which wrote them.
+ */
+class OTPMML_API BinaryDAT
+  : public OT::Object
+{
+  CLASSNAME
+
+public:
+  typedef OT::Collection<OT::Sample> SampleCollection;
+
+  /** Import experiment plane from a binary file, as input and output samples */
+  static SampleCollection Import(const OT::FileName & binaryFile);
+
+  /** Import the given columns of a binary file, inputs being followed by outputs */
+  static OT::Sample Import(const OT::FileName & binaryFile, const OT::Indices & columns);
+
+  /** Names of the columns of a binary file, inputs being followed by outputs */
+  static OT::Description GetColumnNames(const OT::FileName & binaryFile);
+
+  /** Export experiment plane into a binary file */
+  static void Export(const OT::FileName & binaryFile, const OT::Sample & input, const OT::Sample & output);
+
+  /** Convert a .dat file into a binary file */
+  static void ConvertFromDAT(const OT::FileName & datFile, const OT::FileName & binaryFile);
+
+  /** Convert a binary file into a .dat file */
+  static void ConvertToDAT(const OT::FileName & binaryFile, const OT::FileName & datFile);
+
+}; /* class BinaryDAT */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_BINARYDAT_HXX */
@@ -42,14 +42,19 @@ class OTPMML_API DAT
 public:
   typedef OT::Collection<OT::Sample> SampleCollection;
 
-  /** Import experiment plane from a .dat file */
-  static SampleCollection Import(const OT::FileName& datFile);
+  /** Import experiment plane from a .dat file; large files are parsed in chunks
+   *  by numberOfThreads threads, 0 means all hardware threads */
+  static SampleCollection Import(const OT::FileName& datFile,
+                                 const OT::UnsignedInteger numberOfThreads = 0);
 
-  /** Export experiment plane into a .dat file */
-  static void Export(const OT::FileName& datFile, const OT::Sample& input, const OT::Sample& output);
+  /** Export experiment plane into a .dat file; rows are formatted by numberOfThreads
+   *  threads, 0 means all hardware threads */
+  static void Export(const OT::FileName& datFile, const OT::Sample& input, const OT::Sample& output,
+                     const OT::UnsignedInteger numberOfThreads = 0);
 
   /** Export experiment plane into a .dat file */
-  static void Export(const OT::FileName& datFile, const OT::Sample& inputOutput);
+  static void Export(const OT::FileName& datFile, const OT::Sample& inputOutput,
+                     const OT::UnsignedInteger numberOfThreads = 0);
 
 }; /* class DAT */
 
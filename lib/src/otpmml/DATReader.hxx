@@ -0,0 +1,91 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  DATReader.hxx
+ *  @brief Reads a .dat file by batches of rows
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_DATREADER_HXX
+#define OTPMML_DATREADER_HXX
+
+#include <openturns/Sample.hxx>
+#include <openturns/Pointer.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class DATReader
+ *
+ * DATReader reads a .dat file as DAT::Import does, but by batches of batchSize
+ * rows: each batch is a pair of samples, the input columns and the last column.
+ * Batches are parsed by a background thread which stays two batches ahead of
+ * the caller, so that memory does not depend on the size of the file.
+ *
+ * Copies share the position in the file.
+ */
+class OTPMML_API DATReader
+  : public OT::Object
+{
+  CLASSNAME
+
+public:
+  typedef OT::Collection<OT::Sample> SampleCollection;
+
+  /** Parameters constructor; the header is read at once */
+  explicit DATReader(const OT::FileName & datFile,
+                     const OT::UnsignedInteger batchSize = 10000);
+
+  /** Whether another batch can be read; errors found while parsing are thrown here */
+  OT::Bool hasNext() const;
+
+  /** Next batch, as input and output samples of at most batchSize rows */
+  SampleCollection getNext();
+
+  /** Number of rows returned so far */
+  OT::UnsignedInteger getRowsNumber() const;
+
+  /** Descriptions given by the #COLUMN_NAMES: line, empty if the file has none */
+  OT::Description getInputDescription() const;
+  OT::Description getOutputDescription() const;
+
+  /** Number of input columns */
+  OT::UnsignedInteger getInputDimension() const;
+
+  /** Batch size accessor */
+  OT::UnsignedInteger getBatchSize() const;
+
+  /** File name accessor */
+  OT::FileName getFileName() const;
+
+  /** String converter */
+  OT::String __repr__() const override;
+
+private:
+  /** File, parsing thread and parsed batches, see DATReader.cxx */
+  class State;
+
+  OT::Pointer<State> p_state_;
+
+}; /* class DATReader */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_DATREADER_HXX */
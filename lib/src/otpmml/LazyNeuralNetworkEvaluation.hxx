@@ -0,0 +1,124 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LazyNeuralNetworkEvaluation.hxx
+ *  @brief Neural network built on its first evaluation
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_LAZYNEURALNETWORKEVALUATION_HXX
+#define OTPMML_LAZYNEURALNETWORKEVALUATION_HXX
+
+#include <openturns/EvaluationImplementation.hxx>
+#include <openturns/Function.hxx>
+#include <openturns/Indices.hxx>
+#include <openturns/Pointer.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+#include "otpmml/NeuralNetwork.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class LazyNeuralNetworkEvaluation
+ *
+ * LazyNeuralNetworkEvaluation only reads the header of a <NeuralNetwork> element
+ * when it is created: its inputs and outputs, and the size and activation function
+ * of its layers, while neurons are skipped.  The network is built as NeuralNetwork
+ * would build it when it is evaluated for the first time, or when getFunction() is
+ * called; concurrent first calls build it only once.
+ *
+ * Copies share the built network.  A network read from a file keeps only the name
+ * of the file, which is read again when the network is built.
+ */
+class OTPMML_API LazyNeuralNetworkEvaluation
+  : public OT::EvaluationImplementation
+{
+  CLASSNAME
+
+public:
+  /** Default constructor */
+  LazyNeuralNetworkEvaluation();
+
+  /** Parameters constructor */
+  LazyNeuralNetworkEvaluation(const PMMLBuffer & buffer,
+                              const OT::String & modelName,
+                              const NeuralNetwork::EvaluationMode mode,
+                              const OT::FileName & cacheFile);
+
+  /** Virtual constructor */
+  LazyNeuralNetworkEvaluation * clone() const override;
+
+  /** Operator () */
+  OT::Point operator() (const OT::Point & inP) const override;
+  OT::Sample operator() (const OT::Sample & inS) const override;
+
+  /** Accessor for input point dimension */
+  OT::UnsignedInteger getInputDimension() const override;
+
+  /** Accessor for output point dimension */
+  OT::UnsignedInteger getOutputDimension() const override;
+
+  /** Names of the fields read by <NeuralInput> elements */
+  OT::Description getNeuralInputNames() const;
+
+  /** Names of the fields written by <NeuralOutput> elements */
+  OT::Description getNeuralOutputNames() const;
+
+  /** Input dimension followed by the number of neurons of each layer */
+  OT::Indices getLayerSizes() const;
+
+  /** Activation function name of each layer */
+  OT::Description getActivations() const;
+
+  /** Evaluation mode of the network once it is built */
+  NeuralNetwork::EvaluationMode getMode() const;
+
+  /** Whether the network has been built */
+  OT::Bool isLoaded() const;
+
+  /** Function built from the PMML document, which is read on the first call */
+  const OT::Function & getFunction() const;
+
+  /** String converter */
+  OT::String __repr__() const override;
+  OT::String __str__(const OT::String & offset = "") const override;
+
+  /** Method save() stores the object through the StorageManager */
+  void save(OT::Advocate & adv) const override;
+
+  /** Method load() reloads the object from the StorageManager */
+  void load(OT::Advocate & adv) override;
+
+private:
+  /** Document and built network, shared by copies, see LazyNeuralNetworkEvaluation.cxx */
+  struct State;
+
+  OT::Pointer<State> p_state_;
+
+  /** Header of the network */
+  OT::Description inputNames_;
+  OT::Description outputNames_;
+  OT::Indices layerSizes_;
+  OT::Description activations_;
+
+}; /* class LazyNeuralNetworkEvaluation */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_LAZYNEURALNETWORKEVALUATION_HXX */
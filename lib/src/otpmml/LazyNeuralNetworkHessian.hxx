@@ -0,0 +1,85 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LazyNeuralNetworkHessian.hxx
+ *  @brief Hessian of a neural network built on its first use
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_LAZYNEURALNETWORKHESSIAN_HXX
+#define OTPMML_LAZYNEURALNETWORKHESSIAN_HXX
+
+#include <openturns/HessianImplementation.hxx>
+#include <openturns/SymmetricTensor.hxx>
+#include <openturns/Pointer.hxx>
+
+#include "otpmml/LazyNeuralNetworkEvaluation.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class LazyNeuralNetworkHessian
+ *
+ * LazyNeuralNetworkHessian computes the hessian of a LazyNeuralNetworkEvaluation
+ * with the hessian of the network it builds, which is built on the first call.
+ */
+class OTPMML_API LazyNeuralNetworkHessian
+  : public OT::HessianImplementation
+{
+  CLASSNAME
+
+public:
+  typedef OT::Pointer<LazyNeuralNetworkEvaluation> LazyNeuralNetworkEvaluationPointer;
+
+  /** Default constructor */
+  LazyNeuralNetworkHessian();
+
+  /** Parameters constructor */
+  explicit LazyNeuralNetworkHessian(const LazyNeuralNetworkEvaluationPointer & p_evaluation);
+
+  /** Virtual constructor */
+  LazyNeuralNetworkHessian * clone() const override;
+
+  /** Hessian method */
+  OT::SymmetricTensor hessian(const OT::Point & inP) const override;
+
+  /** Accessor for input point dimension */
+  OT::UnsignedInteger getInputDimension() const override;
+
+  /** Accessor for output point dimension */
+  OT::UnsignedInteger getOutputDimension() const override;
+
+  /** String converter */
+  OT::String __repr__() const override;
+  OT::String __str__(const OT::String & offset = "") const override;
+
+  /** Method save() stores the object through the StorageManager */
+  void save(OT::Advocate & adv) const override;
+
+  /** Method load() reloads the object from the StorageManager */
+  void load(OT::Advocate & adv) override;
+
+private:
+  /** The evaluation, shared with the function */
+  LazyNeuralNetworkEvaluationPointer p_evaluation_;
+
+}; /* class LazyNeuralNetworkHessian */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_LAZYNEURALNETWORKHESSIAN_HXX */
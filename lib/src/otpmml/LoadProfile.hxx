@@ -0,0 +1,106 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LoadProfile.hxx
+ *  @brief Time and memory spent in each phase of a model load
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_LOADPROFILE_HXX
+#define OTPMML_LOADPROFILE_HXX
+
+#include <openturns/Object.hxx>
+#include <openturns/Point.hxx>
+#include <openturns/Indices.hxx>
+#include <openturns/Description.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class LoadProfile
+ *
+ * LoadProfile holds, for each phase of the construction of a NeuralNetwork or
+ * of a RegressionModel, the wall time spent in this phase and the growth of the
+ * heap usage between the start and the end of this phase.
+ * A phase may be entered several times, for instance weights and normalizations
+ * are first read from the file and then converted; times and growths are summed.
+ * Profiles are recorded by LoadProfiler.
+ */
+class OTPMML_API LoadProfile
+  : public OT::Object
+{
+  CLASSNAME
+
+public:
+  /** Phases of a load */
+  enum Phase
+  {
+    PARSE = 0,     // reading elements of the model which are neither weights nor normalizations
+    LOOKUP,        // finding the model in the registry, the cache or the file
+    WEIGHTS,       // reading and converting weights and biases
+    NORMALIZATION, // reading and converting inputs and outputs normalizations
+    BUILD,         // building the function
+    CLEANUP,       // releasing the parser and the intermediate model
+    PHASES_NUMBER
+  };
+
+  /** Default constructor, an empty profile */
+  LoadProfile();
+
+  /** Parameters constructor */
+  LoadProfile(const OT::String & category,
+              const OT::String & modelName,
+              const OT::Point & wallTimes,
+              const OT::Indices & memoryGrowth);
+
+  /** Category of the model, NeuralNetwork or RegressionModel; empty if nothing has been loaded */
+  OT::String getCategory() const;
+
+  /** Requested model name */
+  OT::String getModelName() const;
+
+  /** Names of the phases */
+  static OT::Description GetPhaseNames();
+
+  /** Wall time of each phase, in seconds */
+  OT::Point getWallTimes() const;
+
+  /** Total wall time of the load, in seconds */
+  OT::Scalar getTotalWallTime() const;
+
+  /** Heap usage growth of each phase, in bytes: the usage is sampled when the phase starts and ends,
+   *  so memory released within the phase is not counted; 0 when the platform does not tell */
+  OT::Indices getMemoryGrowth() const;
+
+  /** String converters */
+  OT::String __repr__() const override;
+  OT::String __str__(const OT::String & offset = "") const override;
+
+private:
+  OT::String category_;
+  OT::String modelName_;
+  OT::Point wallTimes_;
+  OT::Indices memoryGrowth_;
+
+}; /* class LoadProfile */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_LOADPROFILE_HXX */
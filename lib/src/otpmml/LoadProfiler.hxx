@@ -0,0 +1,65 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  LoadProfiler.hxx
+ *  @brief Opt-in profiling of model loads
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_LOADPROFILER_HXX
+#define OTPMML_LOADPROFILER_HXX
+
+#include "otpmml/OTPMMLprivate.hxx"
+#include "otpmml/LoadProfile.hxx"
+
+namespace OTPMML
+{
+
+class LoadRecorder;
+
+/**
+ * @class LoadProfiler
+ *
+ * When it is enabled, each construction of a NeuralNetwork or of a RegressionModel
+ * records a LoadProfile, which can be read afterwards from the same thread.
+ * Profiling is disabled by default; it then costs nothing.  Memory is measured
+ * from the heap statistics of the C library, which are process-wide: loads run
+ * concurrently by other threads are counted too.
+ */
+class OTPMML_API LoadProfiler
+{
+  friend class LoadRecorder;
+
+public:
+  /** Whether loads are profiled */
+  static void SetEnabled(const OT::Bool enabled);
+  static OT::Bool IsEnabled();
+
+  /** Profile of the last load completed by the calling thread, empty if there is none */
+  static LoadProfile GetLastProfile();
+
+  /** Heap memory in use by the process, in bytes; 0 when the platform does not tell */
+  static OT::UnsignedInteger GetHeapMemoryUsage();
+
+private:
+  static void SetLastProfile(const LoadProfile & profile);
+
+}; /* class LoadProfiler */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_LOADPROFILER_HXX */
@@ -0,0 +1,91 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ModelRegistry.hxx
+ *  @brief Process-wide registry of the models read from PMML files
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_MODELREGISTRY_HXX
+#define OTPMML_MODELREGISTRY_HXX
+
+#include <openturns/LinearLeastSquares.hxx>
+#include <openturns/Pointer.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class ModelRegistry
+ *
+ * ModelRegistry keeps the models built by NeuralNetwork and RegressionModel, so
+ * that building again a model from the same file only shares the registered one.
+ * Models are identified by the canonical path of the file, its modification time
+ * and size, and the requested model name; they are never modified once registered.
+ *
+ * When the memory used by registered models exceeds the capacity, the least
+ * recently used ones are removed.  All methods can be called from any thread.
+ */
+class OTPMML_API ModelRegistry
+{
+public:
+  /** Capacity, in bytes; 0 disables the registry */
+  static void SetCapacity(const OT::UnsignedInteger capacity);
+  static OT::UnsignedInteger GetCapacity();
+
+  /** Number of models found in the registry */
+  static OT::UnsignedInteger GetNumberOfHits();
+
+  /** Number of models which had to be read */
+  static OT::UnsignedInteger GetNumberOfMisses();
+
+  /** Number of models removed to stay within the capacity */
+  static OT::UnsignedInteger GetNumberOfEvictions();
+
+  /** Number of registered models */
+  static OT::UnsignedInteger GetNumberOfModels();
+
+  /** Approximate memory used by registered models, in bytes */
+  static OT::UnsignedInteger GetMemoryUsage();
+
+  /** Remove all models and reset statistics */
+  static void Clear();
+
+  /** Key of a model of a given category (NeuralNetwork or RegressionModel) in a file,
+   *  empty if the file cannot be found or the registry is disabled */
+  static OT::String GetKey(const OT::FileName & pmmlFile, const OT::String & category, const OT::String & modelName);
+
+  /** Get a registered neural network; returns false if it is not registered */
+  static OT::Bool FindNeuralNetwork(const OT::String & key, NeuralNetworkEvaluation & evaluation, OT::String & name);
+
+  /** Register a neural network */
+  static void AddNeuralNetwork(const OT::String & key, const OT::String & name, const NeuralNetworkEvaluation & evaluation);
+
+  /** Get a registered regression model; returns false if it is not registered */
+  static OT::Bool FindRegressionModel(const OT::String & key, OT::Pointer<OT::LinearLeastSquares> & regression);
+
+  /** Register a regression model */
+  static void AddRegressionModel(const OT::String & key, const OT::Pointer<OT::LinearLeastSquares> & regression);
+
+}; /* class ModelRegistry */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_MODELREGISTRY_HXX */
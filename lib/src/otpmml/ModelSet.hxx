@@ -0,0 +1,91 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  ModelSet.hxx
+ *  @brief All the models of a PMML file
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_MODELSET_HXX
+#define OTPMML_MODELSET_HXX
+
+#include <openturns/Function.hxx>
+#include <openturns/Description.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+#include "otpmml/NeuralNetwork.hxx"
+#include "otpmml/RegressionModel.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class ModelSet
+ *
+ * ModelSet reads every named neural network and regression model of a PMML file.
+ * The file is parsed only once, then networks are compiled in parallel; in NATIVE
+ * and SINGLE_PRECISION modes they are also added to the ModelRegistry, so that a
+ * NeuralNetwork built later from the same file and model name shares them.
+ */
+class OTPMML_API ModelSet
+  : public OT::Object
+{
+  CLASSNAME
+
+public:
+  typedef OT::Collection<NeuralNetwork> NeuralNetworkCollection;
+  typedef OT::Collection<RegressionModel> RegressionModelCollection;
+  typedef OT::Collection<OT::Function> FunctionCollection;
+
+  /** Default constructor; numberOfThreads is the number of networks compiled
+   *  at the same time, 0 means all hardware threads */
+  explicit ModelSet(const OT::FileName & pmmlFile,
+                    const NeuralNetwork::EvaluationMode mode = NeuralNetwork::NATIVE,
+                    const OT::UnsignedInteger numberOfThreads = 0);
+
+  /** Constructor from a buffer */
+  explicit ModelSet(const PMMLBuffer & buffer,
+                    const NeuralNetwork::EvaluationMode mode = NeuralNetwork::NATIVE,
+                    const OT::UnsignedInteger numberOfThreads = 0);
+
+  /** Neural networks accessors */
+  OT::UnsignedInteger getNumberOfNeuralNetworks() const;
+  OT::Description getNeuralNetworkNames() const;
+  NeuralNetwork getNeuralNetwork(const OT::UnsignedInteger index) const;
+  NeuralNetwork getNeuralNetwork(const OT::String & modelName) const;
+
+  /** Regression models accessors */
+  OT::UnsignedInteger getNumberOfRegressionModels() const;
+  OT::Description getRegressionModelNames() const;
+  RegressionModel getRegressionModel(const OT::UnsignedInteger index) const;
+  RegressionModel getRegressionModel(const OT::String & modelName) const;
+
+  /** All models as functions: neural networks first, then metamodels of regression models */
+  FunctionCollection getFunctions() const;
+
+  /** String converter */
+  OT::String __repr__() const override;
+
+private:
+  NeuralNetworkCollection networks_;
+  RegressionModelCollection regressions_;
+
+}; /* class ModelSet */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_MODELSET_HXX */
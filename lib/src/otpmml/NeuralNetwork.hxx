@@ -23,27 +23,102 @@
 #define OTPMML_NEURALNETWORK_HXX
 
 #include <openturns/Function.hxx>
+#include <openturns/Matrix.hxx>
+#include <openturns/SymmetricTensor.hxx>
 
 #include "otpmml/OTPMMLprivate.hxx"
+#include "otpmml/PMMLBuffer.hxx"
 
 namespace OTPMML
 {
 
+// Forward declarations
+class PMMLNeuralNetwork;
+class NeuralNetworkEvaluation;
+class LazyNeuralNetworkEvaluation;
+class ModelSet;
+
 /**
  * @class NeuralNetwork
  *
  * The class NeuralNetwork creates a Function from a neural network read in a PMML file.
  * If the PMML file contains several neural networks, the name of the desired neural network must
  * be provided.
+ *
+ * By default, the network and its exact gradient and hessian are evaluated natively
+ * from its weights and biases.  The SINGLE_PRECISION mode evaluates layers natively
+ * with float weights, while the gradient and hessian remain in double precision.
+ * The SYMBOLIC mode builds instead a SymbolicFunction for each layer and composes them.
+ *
+ * In NATIVE and SINGLE_PRECISION modes, a cache file can be given: the compiled network
+ * is written there after it has been read from the PMML file, and later constructions
+ * map this file instead of parsing the PMML file, as long as its contents are unchanged.
+ *
+ * The PMML document can also be given as a PMMLBuffer, for instance to read it from memory.
+ *
+ * In lazy mode, only the header of the network is read by the constructor: its inputs,
+ * outputs, layer sizes and activations.  The network is built on its first evaluation,
+ * or when an accessor needs it, once even when several threads evaluate it together.
  */
 class OTPMML_API NeuralNetwork
   : public OT::Function
 {
   CLASSNAME
 
+  friend class ModelSet;
+  friend class LazyNeuralNetworkEvaluation;
+
 public:
+  /** Evaluation modes */
+  enum EvaluationMode { NATIVE = 0, SYMBOLIC, SINGLE_PRECISION };
+
+  typedef OT::Collection<OT::SymmetricTensor> SymmetricTensorCollection;
+
   /** Default constructor */
-  NeuralNetwork(const OT::FileName & pmmlFile, const OT::String& modelName = "");
+  NeuralNetwork(const OT::FileName & pmmlFile,
+                const OT::String& modelName = "",
+                const EvaluationMode mode = NATIVE,
+                const OT::FileName & cacheFile = "",
+                const OT::Bool lazy = false);
+
+  /** Constructor from a buffer */
+  NeuralNetwork(const PMMLBuffer & buffer,
+                const OT::String& modelName = "",
+                const EvaluationMode mode = NATIVE,
+                const OT::FileName & cacheFile = "",
+                const OT::Bool lazy = false);
+
+  /** Hessian at a point */
+  using OT::Function::hessian;
+
+  /** Hessian at each point of a sample */
+  SymmetricTensorCollection hessian(const OT::Sample & inS) const;
+
+  /** Number of points evaluated together when evaluating a sample, not available in SYMBOLIC mode.
+   *  Settings only apply to this object, not to its copies; setting them builds a lazy network */
+  void setBlockSize(const OT::UnsignedInteger blockSize);
+  OT::UnsignedInteger getBlockSize() const;
+
+  /** Number of threads used to evaluate a sample, not available in SYMBOLIC mode; 0 means automatic */
+  void setNumberOfThreads(const OT::UnsignedInteger numberOfThreads);
+  OT::UnsignedInteger getNumberOfThreads() const;
+
+  /** Input dimension followed by the number of neurons of each layer, not available in SYMBOLIC mode unless lazy */
+  OT::Indices getLayerSizes() const;
+
+  /** Activation function name of each layer, not available in SYMBOLIC mode unless lazy */
+  OT::Description getActivations() const;
+
+  /** Names of the fields read by <NeuralInput> and written by <NeuralOutput> elements, not available in SYMBOLIC mode unless lazy */
+  OT::Description getNeuralInputNames() const;
+  OT::Description getNeuralOutputNames() const;
+
+  /** Whether the network has been built, which is always the case unless it is lazy */
+  OT::Bool isLoaded() const;
+
+  /** Maximum absolute deviation of each output between single and double precision evaluations of a sample,
+   *  not available in SYMBOLIC mode */
+  OT::Point computeSinglePrecisionDeviation(const OT::Sample & inS) const;
 
   /** String converter */
   OT::String __repr__() const override;
@@ -51,6 +126,43 @@ public:
   /** String converter */
   OT::String __str__(const OT::String & offset = "") const override;
 
+private:
+  /** Constructor from a function built by one of the Build methods */
+  explicit NeuralNetwork(const OT::Function & function);
+
+  /** Native evaluation, shared by all copies of this function; a lazy network is built */
+  const NeuralNetworkEvaluation * getNativeEvaluation() const;
+
+  /** Evaluation holding the sample settings, without building a lazy network */
+  const NeuralNetworkEvaluation & getSettingsEvaluation() const;
+
+  /** Replace the native evaluation by one with other settings */
+  void setNativeEvaluation(const NeuralNetworkEvaluation & evaluation);
+
+  /** Lazy evaluation, null if the network is not lazy */
+  const LazyNeuralNetworkEvaluation * getLazyEvaluation() const;
+
+  /** Read the network and build its Function */
+  static OT::Function BuildFunction(const PMMLBuffer & buffer, const OT::String & modelName, const EvaluationMode mode, const OT::FileName & cacheFile);
+
+  /** Build a Function from a native evaluation, with the gradient and hessian sharing it */
+  static OT::Function BuildNativeFunction(const OT::String & name, const NeuralNetworkEvaluation & evaluation, const EvaluationMode mode);
+
+  /** Build a Function by composing a SymbolicFunction for each layer */
+  static OT::Function BuildSymbolicFunction(const PMMLNeuralNetwork & nnet);
+
+  /** Build a native evaluation */
+  static NeuralNetworkEvaluation BuildNativeEvaluation(const PMMLNeuralNetwork & nnet);
+
+  /** Inputs normalization u = (x - center) * scale; returns false if its LinearNorm type is not understood */
+  static OT::Bool ComputeInputsNormalization(const PMMLNeuralNetwork & nnet, OT::Point & center, OT::Point & scale);
+
+  /** Outputs denormalization x = y * scale + shift; returns false if its LinearNorm type is not understood */
+  static OT::Bool ComputeOutputsNormalization(const PMMLNeuralNetwork & nnet, OT::Point & scale, OT::Point & shift);
+
+  /** Fold inputs normalization into weights and bias of the first layer */
+  static void FoldInputsNormalization(const OT::Point & center, const OT::Point & scale, OT::Matrix & weights, OT::Point & bias);
+
 }; /* class PMMLNeuralNetwork */
 
 } /* namespace OTPMML */
@@ -0,0 +1,74 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkCache.hxx
+ *  @brief Binary cache of a compiled neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_NEURALNETWORKCACHE_HXX
+#define OTPMML_NEURALNETWORKCACHE_HXX
+
+#include <openturns/OTprivate.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class NeuralNetworkCache
+ *
+ * NeuralNetworkCache stores the arrays of a NeuralNetworkEvaluation in a binary
+ * file, together with a hash of the PMML file it was read from.  The file is a
+ * sequence of 64-bit words: a header holding the magic string, format version,
+ * source hash and the size of each array, followed by the arrays themselves, so
+ * that it can be memory-mapped and its arrays copied without any parsing.
+ * Words are stored in native byte order, a cache is not meant to be shared
+ * between different platforms.
+ */
+class OTPMML_API NeuralNetworkCache
+{
+public:
+  /** Hash of a byte buffer (64-bit FNV-1a) */
+  static OT::UnsignedInteger ComputeHash(const char * data, const OT::UnsignedInteger size);
+
+  /** Hash of the contents of a file */
+  static OT::UnsignedInteger ComputeFileHash(const OT::FileName & fileName);
+
+  /** Write an evaluation into a cache file; modelName is the requested name, and name the actual one.
+   *  Returns false if the file cannot be written */
+  static OT::Bool Write(const OT::FileName & cacheFile,
+                        const OT::UnsignedInteger sourceHash,
+                        const OT::String & modelName,
+                        const OT::String & name,
+                        const NeuralNetworkEvaluation & evaluation);
+
+  /** Read an evaluation from a cache file; returns false if the file is missing or invalid,
+   *  or if it has been written for another source file or model name */
+  static OT::Bool Read(const OT::FileName & cacheFile,
+                       const OT::UnsignedInteger sourceHash,
+                       const OT::String & modelName,
+                       OT::String & name,
+                       NeuralNetworkEvaluation & evaluation);
+
+}; /* class NeuralNetworkCache */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_NEURALNETWORKCACHE_HXX */
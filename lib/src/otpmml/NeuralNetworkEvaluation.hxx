@@ -0,0 +1,263 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkEvaluation.hxx
+ *  @brief Native evaluation of a feed-forward neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_NEURALNETWORKEVALUATION_HXX
+#define OTPMML_NEURALNETWORKEVALUATION_HXX
+
+#include <openturns/EvaluationImplementation.hxx>
+#include <openturns/Matrix.hxx>
+#include <openturns/Indices.hxx>
+#include <openturns/Pointer.hxx>
+
+#include "otpmml/OTPMMLprivate.hxx"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace OTPMML
+{
+
+/**
+ * @class NeuralNetworkEvaluation
+ *
+ * NeuralNetworkEvaluation evaluates a feed-forward neural network directly from
+ * its weights and biases: each layer is a matrix-vector product followed by its
+ * activation function.  Inputs are normalized by an affine map before entering
+ * the first layer, and outputs of the last layer are denormalized by another
+ * affine map:
+ *   u = (x - inputCenter) * inputScale
+ *   y = v * outputScale + outputShift
+ *
+ * The loader folds the inputs normalization into the first layer when possible,
+ * in which case the first layer reads inputs directly.
+ *
+ * Layers in which at most a quarter of the connections have a non zero weight
+ * are stored as sparse matrices, and only their non zero weights are used.
+ *
+ * Samples are split into blocks of contiguous points, which are spread over
+ * threads; each point is evaluated the same way whatever the number of threads.
+ *
+ * In single precision, layers are evaluated with float copies of the weights and
+ * biases, while normalizations, gradient and hessian use double precision.  The
+ * float copies are only built once single precision is first needed.
+ *
+ * Weights and biases are never modified once the evaluation is built, they are
+ * shared by copies of the evaluation, which only own their sample settings.
+ */
+class OTPMML_API NeuralNetworkEvaluation
+  : public OT::EvaluationImplementation
+{
+  CLASSNAME
+
+  friend class NeuralNetworkGradient;
+  friend class NeuralNetworkHessian;
+  friend struct NeuralNetworkEvaluationPolicy;
+  friend class NeuralNetworkCache;
+
+public:
+  typedef OT::Collection<OT::Matrix> MatrixCollection;
+  typedef OT::Collection<OT::Point> PointCollection;
+
+  /** Default constructor */
+  NeuralNetworkEvaluation();
+
+  /** Parameters constructor; weights of layer l have dimensions size(l-1) x size(l) */
+  NeuralNetworkEvaluation(const OT::Point & inputCenter,
+                          const OT::Point & inputScale,
+                          const MatrixCollection & weights,
+                          const PointCollection & bias,
+                          const OT::Indices & activations,
+                          const OT::Point & outputScale,
+                          const OT::Point & outputShift,
+                          const OT::Description & neuralInputNames = OT::Description(),
+                          const OT::Description & neuralOutputNames = OT::Description());
+
+  /** Virtual constructor */
+  NeuralNetworkEvaluation * clone() const override;
+
+  /** Operator () */
+  OT::Point operator() (const OT::Point & inP) const override;
+  OT::Sample operator() (const OT::Sample & inS) const override;
+
+  /** Number of points evaluated together when evaluating a sample */
+  void setBlockSize(const OT::UnsignedInteger blockSize);
+  OT::UnsignedInteger getBlockSize() const;
+
+  /** Number of threads used to evaluate a sample; 0 lets TBB decide when it is available,
+   *  otherwise uses all the hardware threads */
+  void setNumberOfThreads(const OT::UnsignedInteger numberOfThreads);
+  OT::UnsignedInteger getNumberOfThreads() const;
+
+  /** Whether layers are evaluated in single precision */
+  void setSinglePrecision(const OT::Bool singlePrecision);
+  OT::Bool isSinglePrecision() const;
+
+  /** Maximum absolute deviation of each output between single and double precision evaluations of a sample */
+  OT::Point computeSinglePrecisionDeviation(const OT::Sample & inS) const;
+
+  /** Accessor for input point dimension */
+  OT::UnsignedInteger getInputDimension() const override;
+
+  /** Accessor for output point dimension */
+  OT::UnsignedInteger getOutputDimension() const override;
+
+  /** Number of layers accessor */
+  OT::UnsignedInteger getNumberOfLayers() const;
+
+  /** Layer size accessor */
+  OT::UnsignedInteger getLayerSize(const OT::UnsignedInteger layerIndex) const;
+
+  /** Whether a layer is stored as a sparse matrix */
+  OT::Bool isSparseLayer(const OT::UnsignedInteger layerIndex) const;
+
+  /** Activation function accessor */
+  OT::UnsignedInteger getActivationAtLayer(const OT::UnsignedInteger layerIndex) const;
+
+  /** Names of the fields read by the inputs and written by the outputs of the network, empty if unknown */
+  OT::Description getNeuralInputNames() const;
+  OT::Description getNeuralOutputNames() const;
+
+  /** Approximate memory used by the compiled network, in bytes */
+  OT::UnsignedInteger getMemoryUsage() const;
+
+  /** String converter */
+  OT::String __repr__() const override;
+  OT::String __str__(const OT::String & offset = "") const override;
+
+  /** Method save() stores the object through the StorageManager */
+  void save(OT::Advocate & adv) const override;
+
+  /** Method load() reloads the object from the StorageManager */
+  void load(OT::Advocate & adv) override;
+
+private:
+  /** Compute offsets of each layer into weights_ (or sparseRows_) and bias_;
+   *  the network must not be shared yet */
+  void computeOffsets();
+
+  /** Build the single precision copies of the weights and biases, once even if the network is shared */
+  void computeSinglePrecisionCopies() const;
+
+  /** Normalize a block of contiguous points */
+  void normalizeInputs(const OT::Scalar * inP, const OT::UnsignedInteger size, OT::Scalar * normalized) const;
+
+  /** Apply weights of a layer z = W.a to a block of contiguous vectors */
+  void applyWeights(const OT::UnsignedInteger layerIndex, const OT::Scalar * a, const OT::UnsignedInteger size, OT::Scalar * z) const;
+
+  /** Compute pre-activations z = W.a + b of a layer for a block of contiguous points */
+  void computeLayer(const OT::UnsignedInteger layerIndex, const OT::Scalar * a, const OT::UnsignedInteger size, OT::Scalar * z) const;
+
+  /** Propagate adjoints of pre-activations to the previous layer: previous = adjoint.W */
+  void backpropagateLayer(const OT::UnsignedInteger layerIndex, const OT::Scalar * adjoint, const OT::UnsignedInteger rows, OT::Scalar * previous) const;
+
+  /** Evaluate a block of contiguous points; work must hold 2 * size * maximumWidth_ scalars */
+  void evaluateBlock(const OT::Scalar * inP, const OT::UnsignedInteger size, OT::Scalar * outP, OT::Scalar * work) const;
+
+  /** Compute pre-activations z = W.a + b of a layer in single precision */
+  void computeLayerSinglePrecision(const OT::UnsignedInteger layerIndex, const float * a, const OT::UnsignedInteger size, float * z) const;
+
+  /** Evaluate a block of contiguous points in single precision; work must hold 2 * size * maximumWidth_ floats */
+  void evaluateBlockSinglePrecision(const OT::Scalar * inP, const OT::UnsignedInteger size, OT::Scalar * outP, float * work) const;
+
+  /** Evaluate a sample of valid dimension into outS */
+  void evaluateSample(const OT::Sample & inS, const OT::Bool singlePrecision, OT::Sample & outS) const;
+
+  /** Compiled network; it is never modified once built, and is shared by copies of the evaluation */
+  struct Network
+  {
+    Network()
+      : layerSizes_(1, 0)
+      , singlePrecisionCopies_(false)
+      , maximumWidth_(0)
+      , identityInputsNormalization_(false)
+    {
+    }
+
+    /** Input dimension followed by the number of neurons of each layer */
+    OT::Indices layerSizes_;
+
+    /** Activation type of each layer, see Activation::Type */
+    OT::Indices activations_;
+
+    /** Weights of dense layers; weights of a neuron are stored contiguously */
+    OT::Point weights_;
+
+    /** Whether each layer is stored as a sparse matrix */
+    OT::Indices sparseLayers_;
+
+    /** Non zero weights of sparse layers, neuron by neuron, and the index of their input */
+    OT::Point sparseWeights_;
+    OT::Indices sparseColumns_;
+
+    /** Offset into sparseWeights_ of the first weight of each neuron of sparse layers,
+     *  followed by the end offset of the layer */
+    OT::Indices sparseRows_;
+
+    /** Bias of all layers */
+    OT::Point bias_;
+
+    /** Inputs normalization */
+    OT::Point inputCenter_;
+    OT::Point inputScale_;
+
+    /** Outputs denormalization */
+    OT::Point outputScale_;
+    OT::Point outputShift_;
+
+    /** Names of the fields of the PMML document read by the inputs and written by the outputs */
+    OT::Description neuralInputNames_;
+    OT::Description neuralOutputNames_;
+
+    /** Offsets of each layer into weights_, or into sparseRows_ for sparse layers, and into bias_, not persisted */
+    OT::Indices weightsOffsets_;
+    OT::Indices biasOffsets_;
+
+    /** Single precision copies of weights_, sparseWeights_ and bias_, built on first use, not persisted */
+    std::vector<float> singlePrecisionWeights_;
+    std::vector<float> singlePrecisionSparseWeights_;
+    std::vector<float> singlePrecisionBias_;
+    std::once_flag singlePrecisionOnce_;
+    std::atomic<bool> singlePrecisionCopies_;
+
+    /** Largest number of values stored between two layers, not persisted */
+    OT::UnsignedInteger maximumWidth_;
+
+    /** Whether inputs normalization is the identity, eg when folded into the first layer, not persisted */
+    OT::Bool identityInputsNormalization_;
+  };
+
+  /** Compiled network */
+  OT::Pointer<Network> p_network_;
+
+  /** Sample evaluation settings */
+  OT::UnsignedInteger blockSize_;
+  OT::UnsignedInteger numberOfThreads_;
+
+  /** Whether layers are evaluated in single precision */
+  OT::Bool singlePrecision_;
+
+}; /* class NeuralNetworkEvaluation */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_NEURALNETWORKEVALUATION_HXX */
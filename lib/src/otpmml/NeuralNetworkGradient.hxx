@@ -0,0 +1,86 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkGradient.hxx
+ *  @brief Analytical gradient of a feed-forward neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_NEURALNETWORKGRADIENT_HXX
+#define OTPMML_NEURALNETWORKGRADIENT_HXX
+
+#include <openturns/GradientImplementation.hxx>
+#include <openturns/Pointer.hxx>
+
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class NeuralNetworkGradient
+ *
+ * NeuralNetworkGradient computes the Jacobian of a NeuralNetworkEvaluation with
+ * respect to its inputs.  A forward pass stores the derivatives of activation
+ * functions, then a single reverse pass propagates the adjoints of all outputs
+ * together through the transposed weight matrices.
+ */
+class OTPMML_API NeuralNetworkGradient
+  : public OT::GradientImplementation
+{
+  CLASSNAME
+
+public:
+  typedef OT::Pointer<NeuralNetworkEvaluation> NeuralNetworkEvaluationPointer;
+
+  /** Default constructor */
+  NeuralNetworkGradient();
+
+  /** Parameters constructor */
+  explicit NeuralNetworkGradient(const NeuralNetworkEvaluationPointer & p_evaluation);
+
+  /** Virtual constructor */
+  NeuralNetworkGradient * clone() const override;
+
+  /** Gradient method */
+  OT::Matrix gradient(const OT::Point & inP) const override;
+
+  /** Accessor for input point dimension */
+  OT::UnsignedInteger getInputDimension() const override;
+
+  /** Accessor for output point dimension */
+  OT::UnsignedInteger getOutputDimension() const override;
+
+  /** String converter */
+  OT::String __repr__() const override;
+  OT::String __str__(const OT::String & offset = "") const override;
+
+  /** Method save() stores the object through the StorageManager */
+  void save(OT::Advocate & adv) const override;
+
+  /** Method load() reloads the object from the StorageManager */
+  void load(OT::Advocate & adv) override;
+
+private:
+  /** The evaluation, shared with the function */
+  NeuralNetworkEvaluationPointer p_evaluation_;
+
+}; /* class NeuralNetworkGradient */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_NEURALNETWORKGRADIENT_HXX */
@@ -0,0 +1,115 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  NeuralNetworkHessian.hxx
+ *  @brief Analytical hessian of a feed-forward neural network
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_NEURALNETWORKHESSIAN_HXX
+#define OTPMML_NEURALNETWORKHESSIAN_HXX
+
+#include <openturns/HessianImplementation.hxx>
+#include <openturns/SymmetricTensor.hxx>
+#include <openturns/Sample.hxx>
+#include <openturns/Pointer.hxx>
+
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+
+#include <vector>
+
+namespace OTPMML
+{
+
+/**
+ * @class NeuralNetworkHessian
+ *
+ * NeuralNetworkHessian computes the second derivatives of a NeuralNetworkEvaluation
+ * with respect to its inputs by forward-over-reverse differentiation: a forward
+ * pass propagates the tangents of all input directions through the layers, then a
+ * reverse pass propagates the adjoints of all outputs together with their tangents.
+ */
+class OTPMML_API NeuralNetworkHessian
+  : public OT::HessianImplementation
+{
+  CLASSNAME
+
+public:
+  typedef OT::Pointer<NeuralNetworkEvaluation> NeuralNetworkEvaluationPointer;
+  typedef OT::Collection<OT::SymmetricTensor> SymmetricTensorCollection;
+
+  /** Default constructor */
+  NeuralNetworkHessian();
+
+  /** Parameters constructor */
+  explicit NeuralNetworkHessian(const NeuralNetworkEvaluationPointer & p_evaluation);
+
+  /** Virtual constructor */
+  NeuralNetworkHessian * clone() const override;
+
+  /** Hessian method */
+  OT::SymmetricTensor hessian(const OT::Point & inP) const override;
+
+  /** Hessian at each point of a sample */
+  SymmetricTensorCollection hessian(const OT::Sample & inS) const;
+
+  /** Accessor for input point dimension */
+  OT::UnsignedInteger getInputDimension() const override;
+
+  /** Accessor for output point dimension */
+  OT::UnsignedInteger getOutputDimension() const override;
+
+  /** String converter */
+  OT::String __repr__() const override;
+  OT::String __str__(const OT::String & offset = "") const override;
+
+  /** Method save() stores the object through the StorageManager */
+  void save(OT::Advocate & adv) const override;
+
+  /** Method load() reloads the object from the StorageManager */
+  void load(OT::Advocate & adv) override;
+
+private:
+  /** Buffers of a hessian computation, shared by all the points of a sample */
+  struct Workspace
+  {
+    explicit Workspace(const NeuralNetworkEvaluation & evaluation);
+
+    std::vector<OT::Scalar> derivatives_;
+    std::vector<OT::Scalar> secondDerivatives_;
+    std::vector<OT::Scalar> tangents_;
+    std::vector<OT::Scalar> current_;
+    std::vector<OT::Scalar> next_;
+    std::vector<OT::Scalar> currentTangent_;
+    std::vector<OT::Scalar> nextTangent_;
+    std::vector<OT::Scalar> adjoint_;
+    std::vector<OT::Scalar> previousAdjoint_;
+    std::vector<OT::Scalar> tangentAdjoint_;
+    std::vector<OT::Scalar> previousTangentAdjoint_;
+  };
+
+  /** Compute the hessian at a point given by its components */
+  void computeHessian(const OT::Scalar * inP, Workspace & workspace, OT::SymmetricTensor & result) const;
+
+  /** The evaluation, shared with the function */
+  NeuralNetworkEvaluationPointer p_evaluation_;
+
+}; /* class NeuralNetworkHessian */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_NEURALNETWORKHESSIAN_HXX */
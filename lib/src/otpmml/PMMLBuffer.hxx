@@ -0,0 +1,79 @@
+//                                               -*- C++ -*-
+/**
+ *  @file  PMMLBuffer.hxx
+ *  @brief Contents of a PMML document held in memory
+ *
+ *  Copyright 2014-2018 Airbus-EDF-IMACS-Phimeca
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License.
+ *
+ *  This library is distributed in the hope that it will be useful
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ */
+#ifndef OTPMML_PMMLBUFFER_HXX
+#define OTPMML_PMMLBUFFER_HXX
+
+#include <openturns/Object.hxx>
+#include <openturns/Pointer.hxx>
+
+#include <cstddef>
+
+#include "otpmml/OTPMMLprivate.hxx"
+
+namespace OTPMML
+{
+
+/**
+ * @class PMMLBuffer
+ *
+ * PMMLBuffer holds the bytes of a PMML document, so that models can be read
+ * without a file, for instance from a string.  MapFile maps instead a file into
+ * memory, without copying it; this is what file-based constructors use.
+ * Copies share the same bytes, which are released with the last copy.
+ */
+class OTPMML_API PMMLBuffer
+  : public OT::Object
+{
+  CLASSNAME
+
+public:
+  /** Constructor from bytes, which are copied */
+  PMMLBuffer(const char * data, const std::size_t size);
+
+  /** Map a file into memory */
+  static PMMLBuffer MapFile(const OT::FileName & pmmlFile);
+
+  /** Bytes accessor; they remain valid as long as this buffer or one of its copies exists */
+  const char * getData() const;
+
+  /** Number of bytes */
+  OT::UnsignedInteger getSize() const;
+
+  /** Mapped file, empty if the bytes do not come from a file */
+  OT::FileName getFileName() const;
+
+  /** String converter */
+  OT::String __repr__() const override;
+
+private:
+  struct Storage;
+
+  PMMLBuffer(const OT::Pointer<Storage> & p_storage);
+
+  OT::Pointer<Storage> p_storage_;
+
+}; /* class PMMLBuffer */
+
+} /* namespace OTPMML */
+
+#endif /* OTPMML_PMMLBUFFER_HXX */
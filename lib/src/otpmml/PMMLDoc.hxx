@@ -26,15 +26,28 @@
 #include "otpmml/OTPMMLprivate.hxx"
 #include "otpmml/PMMLNeuralNetwork.hxx"
 #include "otpmml/PMMLRegressionModel.hxx"
+#include "otpmml/PMMLBuffer.hxx"
 
 #include <openturns/LinearLeastSquares.hxx>
 
 #include <libxml/tree.h>
 #include <libxml/xpathInternals.h>
+#include <libxml/xmlreader.h>
+
+#include <unordered_map>
+#include <vector>
 
 namespace OTPMML
 {
 
+/**
+ * @class PMMLDoc
+ *
+ * PMMLDoc holds the tree of a PMML document.  Models are indexed by name when
+ * the document is read, so that looking up a model does not scan the document.
+ * Each XPath query uses its own context, so const methods can be called
+ * concurrently from several threads; methods which modify the document must not.
+ */
 class OTPMML_API PMMLDoc
 {
   friend class PMMLNeuralNetwork;
@@ -42,6 +55,8 @@ class OTPMML_API PMMLDoc
 
 public:
   typedef OT::Collection<OT::String> StringCollection;
+  typedef OT::Collection<PMMLNeuralNetwork> PMMLNeuralNetworkCollection;
+  typedef OT::Collection<PMMLRegressionModel> PMMLRegressionModelCollection;
 
   /** Default constructor */
   PMMLDoc();
@@ -49,6 +64,9 @@ public:
   /** Default constructor */
   PMMLDoc(const OT::FileName & pmmlFile);
 
+  /** Constructor from a buffer */
+  PMMLDoc(const PMMLBuffer & buffer);
+
   /** Default destructor */
   ~PMMLDoc();
 
@@ -58,6 +76,9 @@ public:
   /** Read a PMML from a file */
   OT::Bool read(const OT::FileName & pmmlFile);
 
+  /** Read a PMML from a buffer */
+  OT::Bool read(const PMMLBuffer & buffer);
+
   /** Dump PMML into a file */
   OT::Bool write(const OT::FileName & pmmlFile) const;
 
@@ -88,13 +109,71 @@ public:
   /** Add a header element to current document if there is none */
   void addHeader();
 
+  /** Read the specified neural network from a file or a buffer without building the document tree;
+   *  if headerOnly is true, the neurons of its layers are skipped */
+  static OTPMML::PMMLNeuralNetwork StreamNeuralNetwork(const OT::FileName & pmmlFile, const OT::String & modelName = "", const OT::Bool headerOnly = false);
+  static OTPMML::PMMLNeuralNetwork StreamNeuralNetwork(const PMMLBuffer & buffer, const OT::String & modelName = "", const OT::Bool headerOnly = false);
+
+  /** Read the specified regression model from a file or a buffer without building the document tree */
+  static OTPMML::PMMLRegressionModel StreamRegressionModel(const OT::FileName & pmmlFile, const OT::String & modelName = "");
+  static OTPMML::PMMLRegressionModel StreamRegressionModel(const PMMLBuffer & buffer, const OT::String & modelName = "");
+
+  /** Read every named neural network and regression model of a file or a buffer in a single pass,
+   *  without building the document tree */
+  static void StreamModels(const OT::FileName & pmmlFile,
+                           PMMLNeuralNetworkCollection & networks,
+                           PMMLRegressionModelCollection & regressions);
+  static void StreamModels(const PMMLBuffer & buffer,
+                           PMMLNeuralNetworkCollection & networks,
+                           PMMLRegressionModelCollection & regressions);
+
 private:
   /** Check whether document is initialized */
   void checkInitialized() const;
 
+  /** Models of a category, in document order */
+  struct ModelIndex
+  {
+    ModelIndex() : firstNamedNode_(NULL) {}
+
+    /** modelName attributes, empty for unnamed models */
+    StringCollection names_;
+    /** First model of each name */
+    std::unordered_map<OT::String, xmlNodePtr> nodes_;
+    /** First named model, which is selected when no name is given */
+    xmlNodePtr firstNamedNode_;
+    OT::String firstName_;
+  };
+
+  /** Rebuild the index of models from the children of the root node */
+  void indexModels();
+
+  /** Add a model node to the index of its category, if it is a NeuralNetwork or a RegressionModel */
+  void indexModel(xmlNodePtr node);
+
+  /** Get the index of a given category (NeuralNetwork or RegressionModel) */
+  const ModelIndex & getModelIndex(const OT::String & category) const;
+
+  /** Get the node of the specified model of a given category (NeuralNetwork or RegressionModel),
+   *  and its actual name */
+  xmlNodePtr getModelNode(const OT::String & category, const OT::String & modelName, OT::String & name) const;
+
   /** Get modelName attributes of a given category (NeuralNetwork or RegressionModel) */
   StringCollection getModelNames(const OT::String & category) const;
 
+  /** Open a reader on a buffer, which must outlive the reader */
+  static xmlTextReaderPtr OpenReader(const PMMLBuffer & buffer);
+
+  /** Open a reader on a buffer and move it to the specified model of a given category;
+   *  subtrees of other elements are skipped */
+  static xmlTextReaderPtr OpenModelReader(const PMMLBuffer & buffer,
+                                          const OT::String & category,
+                                          const OT::String & modelName,
+                                          OT::String & name);
+
+  /** Evaluate an XPath query in its own context; result must be freed by caller */
+  xmlXPathObjectPtr evaluateXPathQuery(const OT::String & xpathQuery) const;
+
   /** Get result of an XPath query as a Scalar */
   OT::Scalar getXPathQueryScalar(const OT::String & xpathQuery) const;
 
@@ -108,12 +187,13 @@ private:
   /** Pointer to the root node of the document */
   xmlNodePtr rootNode_;
 
-  /** Pointer to the context used by XPath queries */
-  xmlXPathContextPtr xpathContext_;
-
   /** Prefix used by XPath queries; this is needed if a namespace is declared in XML document */
   OT::String xpathNsPrefix_;
 
+  /** Models by name, rebuilt each time the document is read or reset */
+  ModelIndex neuralNetworks_;
+  ModelIndex regressionModels_;
+
 }; /* class PMMLDoc */
 
 } /* namespace OTPMML */
@@ -25,10 +25,16 @@
 
 #include <openturns/Matrix.hxx>
 #include <openturns/Function.hxx>
+#include <openturns/Sample.hxx>
+#include <openturns/Indices.hxx>
+#include <openturns/Description.hxx>
 
 #include "otpmml/OTPMMLprivate.hxx"
 
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+
+#include <vector>
 
 namespace OTPMML
 {
@@ -36,12 +42,28 @@ namespace OTPMML
 // Forward declaration
 class PMMLDoc;
 
+/**
+ * @class PMMLNeuralNetwork
+ *
+ * PMMLNeuralNetwork reads a <NeuralNetwork> element in a single walk through its
+ * subtree; getters then only access this in-memory model, and not the document.
+ * The element is either a node of a PMMLDoc tree, or the current element of an
+ * xmlTextReader stream, in which case weights are stored as they are read.
+ *
+ * A stream can also be read without the neurons of its layers, to get quickly the
+ * inputs, outputs, layer sizes and activations of a network; weights and biases of
+ * such a header-only model are null.
+ */
 class OTPMML_API PMMLNeuralNetwork
 {
 public:
   /** Default constructor */
   PMMLNeuralNetwork(const PMMLDoc * pmml, const OT::String & modelName, const xmlNodePtr & node);
 
+  /** Constructor from a reader positioned on a <NeuralNetwork> element; the reader is moved past its end.
+   *  If headerOnly is true, the neurons of layers are skipped */
+  PMMLNeuralNetwork(const OT::String & modelName, xmlTextReaderPtr reader, const OT::Bool headerOnly = false);
+
   /** Get model name */
   OT::String getModelName() const;
 
@@ -60,6 +82,15 @@ public:
   /** Get variable name associated to <NeuralInput> with given id attribute */
   OT::String getNeuralInputName(OT::UnsignedInteger id) const;
 
+  /** Get variable names of <NeuralInput> elements, in document order */
+  OT::Description getNeuralInputNames() const;
+
+  /** Get variable names of <NeuralOutput> elements, in document order */
+  OT::Description getNeuralOutputNames() const;
+
+  /** Whether neurons of layers have been skipped */
+  OT::Bool isHeaderOnly() const;
+
   /** Get bias of neurons in the given layer */
   OT::Point getBiasAtLayer(OT::UnsignedInteger layerIndex) const;
 
@@ -78,6 +109,10 @@ public:
   /** Get coefficients needed to normalize outputs */
   OT::Sample getOutputsNormalization() const;
 
+  /** Get normalization type of coefficients returned by getInputsNormalization or getOutputsNormalization:
+   *  1 or 2 for the LinearNorm cases which are understood, 0 otherwise */
+  static OT::UnsignedInteger GetNormalizationType(const OT::Sample & normalization);
+
   /** Get input normalization as a Function */
   OT::Function getInputsNormalizationFunction() const;
 
@@ -87,18 +122,64 @@ public:
   /** Get evaluation function of a given layer as a Function */
   OT::Function getEvaluationFunctionAtLayer(OT::UnsignedInteger layerIndex) const;
 
+  /** Build evaluation function of a layer from its coefficients; outputs are denormalized if outputScale is not empty */
+  static OT::Function BuildLayerFunction(const OT::Matrix & weights,
+                                         const OT::Point & bias,
+                                         const OT::String & activation,
+                                         const OT::Point & outputScale = OT::Point(),
+                                         const OT::Point & outputShift = OT::Point());
+
 private:
-  /** Set XPath context to node_ */
-  void setXPathContext() const;
+  /** Contents of a <NeuralLayer> element */
+  struct Layer
+  {
+    /** activationFunction attribute, or the one of <NeuralNetwork> if missing */
+    OT::String activationFunction_;
 
-  /** Pointer to parent PMMLDoc instance */
-  const PMMLDoc * pmml_;
+    /** numberOfNeurons attribute */
+    OT::UnsignedInteger numberOfNeurons_;
+
+    /** Ids of neurons, empty if their number does not match numberOfNeurons_ */
+    OT::Indices neuronIds_;
+
+    /** Bias of neurons, null if their number does not match numberOfNeurons_ */
+    OT::Point bias_;
+
+    /** Weights, dimensions are size(previous layer) x numberOfNeurons_ */
+    OT::Matrix weights_;
+  };
+
+  /** Builds layers from their neurons and connections, see PMMLNeuralNetwork.cxx */
+  struct LayerReader;
+
+  /** Fill the model by walking once the <NeuralNetwork> element */
+  void readModel(const xmlNodePtr & node);
+  void readModel(xmlTextReaderPtr reader, const OT::Bool headerOnly);
 
   /** Model name */
   const OT::String modelName_;
 
-  /** Pointer to the <NeuralNetwork> XML element */
-  const xmlNodePtr node_;
+  /** numberOfInputs, numberOfOutputs and numberOfLayers attributes */
+  OT::UnsignedInteger numberOfInputs_;
+  OT::UnsignedInteger numberOfOutputs_;
+  OT::UnsignedInteger numberOfLayers_;
+
+  /** Id of each <NeuralInput> and name of the field it normalizes */
+  OT::Indices inputIds_;
+  OT::Description inputNames_;
+
+  /** Name of the field denormalized by each <NeuralOutput> */
+  OT::Description outputNames_;
+
+  /** Whether neurons of layers have been skipped */
+  OT::Bool headerOnly_;
+
+  /** Coefficients of <LinearNorm> elements of inputs and outputs */
+  OT::Sample inputsNormalization_;
+  OT::Sample outputsNormalization_;
+
+  /** Layers, in document order */
+  std::vector<Layer> layers_;
 
 }; /* class PMMLNeuralNetwork */
 
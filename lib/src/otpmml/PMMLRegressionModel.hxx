@@ -24,10 +24,12 @@
 #define OTPMML_PMMLREGRESSIONMODEL_HXX
 
 #include <openturns/Sample.hxx>
+#include <openturns/Description.hxx>
 
 #include "otpmml/OTPMMLprivate.hxx"
 
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 
 namespace OTPMML
 {
@@ -35,6 +37,13 @@ namespace OTPMML
 // Forward declaration
 class PMMLDoc;
 
+/**
+ * @class PMMLRegressionModel
+ *
+ * PMMLRegressionModel reads a <RegressionModel> element in a single walk through
+ * its subtree, either from a PMMLDoc tree or from an xmlTextReader stream.
+ * Unsupported features are reported when coefficients are accessed.
+ */
 class OTPMML_API PMMLRegressionModel
 {
 public:
@@ -43,6 +52,9 @@ public:
   /** Default constructor */
   PMMLRegressionModel(const PMMLDoc * pmml, const OT::String & modelName, const xmlNodePtr & node);
 
+  /** Constructor from a reader positioned on a <RegressionModel> element; the reader is moved past its end */
+  PMMLRegressionModel(const OT::String & modelName, xmlTextReaderPtr reader);
+
   /** Get model name */
   OT::String getModelName() const;
 
@@ -56,23 +68,44 @@ public:
   OT::Sample getCoefficients() const;
 
 private:
-  /** Set XPath context to node_ */
-  void setXPathContext() const;
+  /** Fill the model by walking once the <RegressionModel> element */
+  void readModel(const xmlNodePtr & node);
+  void readModel(xmlTextReaderPtr reader);
+
+  /** Error message for unsupported attributes of <RegressionModel>, empty if they are supported */
+  static OT::String CheckModelAttributes(const char * modelType, const char * functionName, const char * normalizationMethod);
+
+  /** Error message for an unsupported child of <RegressionTable>, empty if it is supported */
+  static OT::String CheckPredictorElement(const xmlChar * name);
+
+  /** Error message for an unsupported exponent attribute, empty if it is supported */
+  static OT::String CheckPredictorExponent(const char * exponent);
+
+  /** Store the contents of the <RegressionTable> element, and the first unsupported feature */
+  void setRegressionTable(const OT::UnsignedInteger numberOfTables,
+                          const OT::Description & names,
+                          const OT::Point & coefficients,
+                          const OT::Bool hasExponent,
+                          const OT::String & elementError,
+                          const OT::String & exponentError);
 
   /** Checks that this is a linearRegression model */
   void checkValid() const;
 
-  /** Pointer to parent PMMLDoc instance */
-  const PMMLDoc * pmml_;
-
   /** Model name */
   const OT::String modelName_;
 
-  /** Pointer to the <RegressionModel> XML element */
-  const xmlNodePtr node_;
+  /** targetFieldName attribute */
+  OT::String targetVariableName_;
+
+  /** intercept attribute of the <RegressionTable> element */
+  OT::Scalar intercept_;
+
+  /** Coefficients of <NumericPredictor> elements */
+  OT::Sample coefficients_;
 
-  /** Flag to validate model only once */
-  mutable OT::Bool validated_;
+  /** First unsupported feature which has been found, empty if the model is valid */
+  OT::String error_;
 
 }; /* class PMMLRegressionModel */
 
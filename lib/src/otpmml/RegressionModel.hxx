@@ -26,17 +26,22 @@
 #include <openturns/LinearLeastSquares.hxx>
 
 #include "otpmml/OTPMMLprivate.hxx"
+#include "otpmml/PMMLBuffer.hxx"
 
 namespace OTPMML
 {
 
+// Forward declarations
+class PMMLRegressionModel;
+class ModelSet;
+
 /**
  * @class RegressionModel
  *
  * The class RegressionModel allows reading a regression model from a PMML file.
  * If the PMML file contains several regression models, the name of the desired regression model must
  * be provided.  Method getLinearLeastSquares can then be used to transform it into a LinearLeastSquares
- * instance.
+ * instance.  The PMML document can also be given as a PMMLBuffer, for instance to read it from memory.
  *
  * In order to export a LinearLeastSquares instance into a PMML file, a RegressionModel instance is
  * built from this LinearLeastSquares instance, and method exportToPMMLFile can then be called.
@@ -44,10 +49,15 @@ namespace OTPMML
 class OTPMML_API RegressionModel
   : public OT::PersistentObject
 {
+  friend class ModelSet;
+
 public:
   /** Default constructor */
   RegressionModel(const OT::FileName & pmmlFile, const OT::String& modelName = "");
 
+  /** Constructor from a buffer */
+  RegressionModel(const PMMLBuffer & buffer, const OT::String& modelName = "");
+
   /** Default constructor */
   RegressionModel(const OT::LinearLeastSquares & implementation);
 
@@ -70,6 +80,12 @@ public:
   virtual void load(OT::Advocate & adv);
 
 private:
+  /** Constructor from a model built by BuildLinearLeastSquares */
+  explicit RegressionModel(const OT::Pointer<OT::LinearLeastSquares> & metamodel);
+
+  /** Build the LinearLeastSquares of a model */
+  static OT::Pointer<OT::LinearLeastSquares> BuildLinearLeastSquares(const PMMLRegressionModel & model);
+
   OT::Pointer<OT::LinearLeastSquares> metamodel_;
 }; /* class RegressionModel */
 
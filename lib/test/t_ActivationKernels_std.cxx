@@ -0,0 +1,54 @@
+#include <iostream>
+#include <cmath>
+
+// OT includes
+#include <openturns/OT.hxx>
+
+#include "otpmml/Activation.hxx"
+#include "otpmml/ActivationKernels.hxx"
+
+using namespace OT;
+using namespace OTPMML;
+
+int main()
+{
+  // Regular grid, and arguments close to the thresholds of the kernels
+  Point x;
+  for (SignedInteger i = -4000; i <= 4000; ++i)
+    x.add(0.0123456789 * i);
+  const Scalar special[] = {0.0, 1.e-300, 1.e-8, 0.625, 0.66, 2.41421356237309504880, 22.0, 40.0, 700.0, 709.7, 709.8, 710.0, 745.0, 750.0, 1.e3,
+                            1.e5, 1.e7, 9.9e7, 1.0e8, 1.01e8, 1.e10, 1.e300
+                           };
+  for (UnsignedInteger i = 0; i < sizeof(special) / sizeof(special[0]); ++i)
+  {
+    x.add(special[i]);
+    x.add(-special[i]);
+  }
+
+  const ActivationKernels::InstructionSet supported = ActivationKernels::GetSupportedInstructionSet();
+  for (UnsignedInteger type = Activation::IDENTITY; type <= Activation::ARCTAN; ++type)
+  {
+    // Absolute tolerance for functions bounded by 1, relative one otherwise
+    const Bool bounded = (type == Activation::TANH) || (type == Activation::LOGISTIC) || (type == Activation::GAUSS) || (type == Activation::SINE) || (type == Activation::COSINE) || (type == Activation::ELLIOTT) || (type == Activation::ARCTAN);
+    Bool ok = true;
+    for (UnsignedInteger instructionSet = ActivationKernels::SCALAR; instructionSet <= supported; ++instructionSet)
+    {
+      ActivationKernels::SetInstructionSet(static_cast<ActivationKernels::InstructionSet>(instructionSet));
+      // Odd size, so that the tail of each kernel is exercised
+      Point values(x);
+      ActivationKernels::Evaluate(type, &values[0], values.getSize());
+      for (UnsignedInteger i = 0; i < x.getSize(); ++i)
+      {
+        const Scalar reference = Activation::Evaluate(type, x[i]);
+        const Scalar error = std::abs(values[i] - reference);
+        if ((reference == values[i]) || (error <= 4.e-15 * (bounded ? 1.0 : std::abs(reference)))) continue;
+        std::cout << Activation::GetName(type) << ": " << ActivationKernels::GetInstructionSetName(instructionSet) << " kernel gives " << values[i] << " at " << x[i] << ", expected " << reference << std::endl;
+        ok = false;
+      }
+    }
+    std::cout << Activation::GetName(type) << (ok ? " OK" : " FAILED") << std::endl;
+  }
+  ActivationKernels::SetInstructionSet(supported);
+
+  return 0;
+}
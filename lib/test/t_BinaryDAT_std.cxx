@@ -0,0 +1,45 @@
+#include <iostream>
+// OT includes
+#include <openturns/OT.hxx>
+
+#include "otpmml/DAT.hxx"
+#include "otpmml/BinaryDAT.hxx"
+
+using namespace OT;
+using namespace OTPMML;
+
+int main()
+{
+  const Collection<Sample> samples(DAT::Import("input_output.dat"));
+
+  // Conversions in both directions keep values and descriptions
+  BinaryDAT::ConvertFromDAT("input_output.dat", "input_output.bin");
+  std::cout << "Column names = " << BinaryDAT::GetColumnNames("input_output.bin") << std::endl;
+  const Collection<Sample> binary(BinaryDAT::Import("input_output.bin"));
+  std::cout << "Binary samples are the same = " << ((binary[0] == samples[0]) && (binary[1] == samples[1])) << std::endl;
+  std::cout << "Descriptions = " << binary[0].getDescription() << " " << binary[1].getDescription() << std::endl;
+  BinaryDAT::ConvertToDAT("input_output.bin", "input_output_back.dat");
+  const Collection<Sample> back(DAT::Import("input_output_back.dat"));
+  std::cout << "Converted back samples are the same = " << ((back[0] == samples[0]) && (back[1] == samples[1])) << std::endl;
+
+  // Selected columns
+  Indices columns(2);
+  columns[0] = 4;
+  columns[1] = 1;
+  const Sample selected(BinaryDAT::Import("input_output.bin", columns));
+  std::cout << "Selected columns = " << selected.getDescription() << " size=" << selected.getSize()
+            << " same values = " << ((selected.getMarginal(0) == samples[1]) && (selected.getMarginal(1) == samples[0].getMarginal(1))) << std::endl;
+
+  // A .dat file is not a binary file
+  try
+  {
+    BinaryDAT::Import("input_output.dat");
+    std::cout << "Text file has been read" << std::endl;
+  }
+  catch (const InvalidArgumentException &)
+  {
+    std::cout << "Text file is rejected" << std::endl;
+  }
+
+  return 0;
+}
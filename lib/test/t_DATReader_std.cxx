@@ -0,0 +1,80 @@
+#include <iostream>
+#include <fstream>
+// OT includes
+#include <openturns/OT.hxx>
+
+#include "otpmml/DAT.hxx"
+#include "otpmml/DATReader.hxx"
+
+using namespace OT;
+using namespace OTPMML;
+
+int main()
+{
+  const Collection<Sample> samples(DAT::Import("input_output.dat"));
+
+  // Batches of 30 rows, the last one is smaller
+  DATReader reader("input_output.dat", 30);
+  std::cout << "Input description = " << reader.getInputDescription() << std::endl;
+  std::cout << "Output description = " << reader.getOutputDescription() << std::endl;
+  Sample input(0, reader.getInputDimension());
+  Sample output(0, 1);
+  while (reader.hasNext())
+  {
+    const Collection<Sample> batch(reader.getNext());
+    std::cout << "Batch of " << batch[0].getSize() << " rows, description = " << batch[0].getDescription() << batch[1].getDescription() << std::endl;
+    input.add(batch[0]);
+    output.add(batch[1]);
+  }
+  std::cout << "Rows read = " << reader.getRowsNumber() << std::endl;
+  std::cout << "Same as DAT::Import = " << ((input == samples[0]) && (output == samples[1])) << std::endl;
+
+  // Files without column names, or with an empty #COLUMN_NAMES: line, are read as DAT::Import reads them
+  {
+    std::ofstream headerless("reader_headerless.dat");
+    for (UnsignedInteger i = 0; i < 5; ++i)
+      headerless << i << " " << 2 * i << " " << 3 * i << std::endl;
+    std::ofstream emptyHeader("reader_empty_header.dat");
+    emptyHeader << "#COLUMN_NAMES:" << std::endl;
+    for (UnsignedInteger i = 0; i < 5; ++i)
+      emptyHeader << i << " " << 2 * i << " " << 3 * i << std::endl;
+  }
+  const char * noNamesFiles[] = {"reader_headerless.dat", "reader_empty_header.dat"};
+  for (UnsignedInteger k = 0; k < 2; ++k)
+  {
+    const Collection<Sample> reference(DAT::Import(noNamesFiles[k]));
+    DATReader noNamesReader(noNamesFiles[k], 2);
+    Sample noNamesInput(0, noNamesReader.getInputDimension());
+    Sample noNamesOutput(0, 1);
+    while (noNamesReader.hasNext())
+    {
+      const Collection<Sample> batch(noNamesReader.getNext());
+      noNamesInput.add(batch[0]);
+      noNamesOutput.add(batch[1]);
+    }
+    std::cout << noNamesFiles[k] << ": rows read = " << noNamesReader.getRowsNumber()
+              << " same as DAT::Import = " << ((noNamesInput == reference[0]) && (noNamesOutput == reference[1])) << std::endl;
+  }
+
+  // Rows before a malformed one are returned first
+  {
+    std::ofstream malformed("reader_malformed.dat");
+    malformed << "#COLUMN_NAMES: x| y" << std::endl << std::endl;
+    for (UnsignedInteger i = 0; i < 25; ++i)
+      malformed << i << " " << 2 * i << std::endl;
+    malformed << "1,5 2.5" << std::endl;
+  }
+  DATReader malformedReader("reader_malformed.dat", 10);
+  try
+  {
+    while (malformedReader.hasNext())
+      malformedReader.getNext();
+    std::cout << "Malformed value has been read" << std::endl;
+  }
+  catch (const InvalidArgumentException &)
+  {
+    std::cout << "Malformed value is reported after " << malformedReader.getRowsNumber() << " rows" << std::endl;
+  }
+
+  return 0;
+}
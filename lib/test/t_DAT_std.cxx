@@ -1,5 +1,7 @@
 #include <iostream>
 #include <cmath>
+#include <fstream>
+#include <iterator>
 
 // OT includes
 #include <openturns/OT.hxx>
@@ -35,6 +37,79 @@ int main()
   }
 
   DAT::Export("export.dat", samples[0], samples[1]);
+  const Collection<Sample> exported(DAT::Import("export.dat"));
+  std::cout << "Exported samples are read back = " << ((exported[0] == samples[0]) && (exported[1] == samples[1]) && (exported[0].getDescription() == samples[0].getDescription())) << std::endl;
+
+  // Windows ends of line, blank lines and comments between rows
+  {
+    std::ofstream crlf("crlf.dat", std::ios::binary);
+    crlf << "#COLUMN_NAMES: a | b\r\n\r\n1 2\r\n   \r\n# comment\r\n3 4\r\n";
+  }
+  const Collection<Sample> crlfSamples(DAT::Import("crlf.dat"));
+  std::cout << "CRLF file: " << crlfSamples[0].getDescription() << " " << crlfSamples[1].getDescription()
+            << " size=" << crlfSamples[0].getSize() << " last row=" << crlfSamples[0](1, 0) << " " << crlfSamples[1](1, 0) << std::endl;
+
+  // Decimal commas are not numbers
+  {
+    std::ofstream malformed("malformed.dat");
+    malformed << "#COLUMN_NAMES: x| y" << std::endl << std::endl;
+    malformed << "1.5 2.5" << std::endl;
+    malformed << "1,5 2.5" << std::endl;
+  }
+  try
+  {
+    DAT::Import("malformed.dat");
+    std::cout << "Malformed value has been read" << std::endl;
+  }
+  catch (const InvalidArgumentException &)
+  {
+    std::cout << "Malformed value is reported" << std::endl;
+  }
+
+  // Large files are parsed in chunks by several threads
+  {
+    std::ofstream large("large.dat");
+    large << "#COLUMN_NAMES: u| v| w" << std::endl << std::endl;
+    for (UnsignedInteger i = 0; i < 200000; ++i)
+    {
+      if (i % 1000 == 0) large << "# block " << i / 1000 << std::endl;
+      large << i << " " << i << ".5 " << 2 * i << std::endl;
+    }
+  }
+  const Collection<Sample> sequential(DAT::Import("large.dat", 1));
+  const Collection<Sample> parallel(DAT::Import("large.dat", 4));
+  std::cout << "Large file: size=" << parallel[0].getSize() << " last row=" << parallel[0](199999, 0) << " " << parallel[1](199999, 0)
+            << " same as sequential = " << ((parallel[0] == sequential[0]) && (parallel[1] == sequential[1])) << std::endl;
+
+  // Rows formatted by several threads are written in order
+  DAT::Export("large_export_1.dat", parallel[0], parallel[1], 1);
+  DAT::Export("large_export_4.dat", parallel[0], parallel[1], 4);
+  std::ifstream export1("large_export_1.dat", std::ios::binary);
+  std::ifstream export4("large_export_4.dat", std::ios::binary);
+  const String text1((std::istreambuf_iterator<char>(export1)), std::istreambuf_iterator<char>());
+  const String text4((std::istreambuf_iterator<char>(export4)), std::istreambuf_iterator<char>());
+  const Collection<Sample> reimported(DAT::Import("large_export_4.dat"));
+  std::cout << "Large export: same file = " << (text1 == text4) << " read back = " << ((reimported[0] == parallel[0]) && (reimported[1] == parallel[1])) << std::endl;
+
+  // A malformed row far from the beginning is reported with its line number
+  {
+    std::ofstream large("large_malformed.dat");
+    large << "#COLUMN_NAMES: u| v| w" << std::endl << std::endl;
+    for (UnsignedInteger i = 0; i < 200000; ++i)
+    {
+      if (i == 150000) large << "1 2,5 3" << std::endl;
+      else large << i << " " << i << ".5 " << 2 * i << std::endl;
+    }
+  }
+  try
+  {
+    DAT::Import("large_malformed.dat", 4);
+    std::cout << "Malformed row has been read" << std::endl;
+  }
+  catch (const InvalidArgumentException & ex)
+  {
+    std::cout << "Malformed row is reported at line 150003 = " << (String(ex.what()).find("at line 150003 ") != String::npos) << std::endl;
+  }
 
   return 0;
 }
@@ -0,0 +1,55 @@
+#include <iostream>
+// OT includes
+#include <openturns/OT.hxx>
+
+#include "otpmml/ModelSet.hxx"
+#include "otpmml/ModelRegistry.hxx"
+
+using namespace OT;
+using namespace OTPMML;
+
+int main()
+{
+  ModelRegistry::Clear();
+  const ModelSet models("multiple_models.pmml");
+  std::cout << "Number of neural networks = " << models.getNumberOfNeuralNetworks() << std::endl;
+  std::cout << "Neural network names = " << models.getNeuralNetworkNames() << std::endl;
+  std::cout << "Number of regression models = " << models.getNumberOfRegressionModels() << std::endl;
+  std::cout << "Regression model names = " << models.getRegressionModelNames() << std::endl;
+  std::cout << "Number of functions = " << models.getFunctions().getSize() << std::endl;
+  std::cout << "Registered models = " << ModelRegistry::GetNumberOfModels() << std::endl;
+
+  // Both networks are copies of the same one
+  const NeuralNetwork reference("uranie_ann_poutre.pmml");
+  Point x(4);
+  x[0] = 3.048020426e+00;
+  x[1] = 4.429896757e+04;
+  x[2] = 2.550648980e+02;
+  x[3] = 3.711170093e+02;
+  for (UnsignedInteger i = 0; i < models.getNumberOfNeuralNetworks(); ++i)
+    if (!(models.getNeuralNetwork(i)(x) == reference(x)))
+      std::cout << "Evaluation of network " << i << " differs" << std::endl;
+  if (!(models.getNeuralNetwork("ANNPoutreBis").gradient(x) == reference.gradient(x)))
+    std::cout << "Gradient of network ANNPoutreBis differs" << std::endl;
+
+  // Networks are shared with those built later from the same file
+  const UnsignedInteger hits = ModelRegistry::GetNumberOfHits();
+  const NeuralNetwork network("multiple_models.pmml", "ANNPoutreBis");
+  std::cout << "Registry hits = " << ModelRegistry::GetNumberOfHits() - hits << std::endl;
+
+  // Results do not depend on the number of threads, nor on the mode
+  const ModelSet sequentialModels("multiple_models.pmml", NeuralNetwork::NATIVE, 1);
+  if (!(sequentialModels.getNeuralNetwork(1)(x) == models.getNeuralNetwork(1)(x)))
+    std::cout << "Sequential evaluation differs" << std::endl;
+  const ModelSet symbolicModels("multiple_models.pmml", NeuralNetwork::SYMBOLIC);
+  const Scalar symbolicValue = symbolicModels.getNeuralNetwork("ANNPoutre")(x)[0];
+  if (std::abs(symbolicValue - reference(x)[0]) > 1.e-10 * std::abs(reference(x)[0]))
+    std::cout << "Symbolic evaluation differs" << std::endl;
+
+  const LinearLeastSquares leastSquares(models.getRegressionModel("Claims").getLinearLeastSquares());
+  std::cout << "Linear regression:" << std::endl;
+  std::cout << "   constant = " << leastSquares.getConstant() << std::endl;
+  std::cout << "   linear = " << leastSquares.getLinear() << std::endl;
+
+  return 0;
+}
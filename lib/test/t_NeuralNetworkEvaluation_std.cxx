@@ -0,0 +1,117 @@
+#include <iostream>
+#include <cmath>
+
+// OT includes
+#include <openturns/OT.hxx>
+
+#include "otpmml/Activation.hxx"
+#include "otpmml/NeuralNetworkEvaluation.hxx"
+#include "otpmml/NeuralNetworkGradient.hxx"
+#include "otpmml/NeuralNetworkHessian.hxx"
+
+using namespace OT;
+using namespace OTPMML;
+
+int main()
+{
+  // 6 inputs -> 8 neurons with 10 connections -> 5 fully connected neurons -> 2 outputs with 2 connections
+  const UnsignedInteger sizes[] = {6, 8, 5, 2};
+  Indices activations(3);
+  activations[0] = Activation::TANH;
+  activations[1] = Activation::LOGISTIC;
+  activations[2] = Activation::IDENTITY;
+  NeuralNetworkEvaluation::MatrixCollection weights(3);
+  NeuralNetworkEvaluation::PointCollection bias(3);
+  for (UnsignedInteger layer = 0; layer < 3; ++layer)
+  {
+    weights[layer] = Matrix(sizes[layer], sizes[layer + 1]);
+    bias[layer] = Point(sizes[layer + 1]);
+    for (UnsignedInteger i = 0; i < sizes[layer + 1]; ++i)
+    {
+      bias[layer][i] = 0.1 * std::cos(1.0 + i + layer);
+      for (UnsignedInteger k = 0; k < sizes[layer]; ++k)
+        if ((layer == 1) || ((3 * i + k + layer) % 5 == 0))
+          weights[layer](k, i) = std::sin(1.0 + k + 2.0 * i + 3.0 * layer);
+    }
+  }
+  Point inputCenter(6);
+  Point inputScale(6);
+  for (UnsignedInteger k = 0; k < 6; ++k)
+  {
+    inputCenter[k] = 10.0 * k;
+    inputScale[k] = 1.0 / (1.0 + k);
+  }
+  Point outputScale(2, 3.0);
+  Point outputShift(2, -1.0);
+  const NeuralNetworkGradient::NeuralNetworkEvaluationPointer p_evaluation(new NeuralNetworkEvaluation(inputCenter, inputScale, weights, bias, activations, outputScale, outputShift));
+  const NeuralNetworkEvaluation & evaluation = *p_evaluation;
+  std::cout << evaluation.__str__() << std::endl;
+  for (UnsignedInteger layer = 0; layer < 3; ++layer)
+    std::cout << "layer " << layer << " sparse=" << evaluation.isSparseLayer(layer) << std::endl;
+
+  // Points spread around the input centers
+  Sample input(50, 6);
+  for (UnsignedInteger i = 0; i < input.getSize(); ++i)
+    for (UnsignedInteger k = 0; k < 6; ++k)
+      input(i, k) = inputCenter[k] + (1.0 + k) * std::sin(0.7 * i + 1.3 * k);
+
+  // Sparse layers must give the same values as the dense matrices
+  const Sample output(evaluation(input));
+  for (UnsignedInteger i = 0; i < input.getSize(); ++i)
+  {
+    Point a(6);
+    for (UnsignedInteger k = 0; k < 6; ++k)
+      a[k] = (input(i, k) - inputCenter[k]) * inputScale[k];
+    for (UnsignedInteger layer = 0; layer < 3; ++layer)
+    {
+      Point z(weights[layer].transpose() * a + bias[layer]);
+      for (UnsignedInteger j = 0; j < z.getDimension(); ++j)
+        z[j] = Activation::Evaluate(activations[layer], z[j]);
+      a = z;
+    }
+    for (UnsignedInteger j = 0; j < 2; ++j)
+    {
+      const Scalar reference = a[j] * outputScale[j] + outputShift[j];
+      if (std::abs(output(i, j) - reference) > 1.e-14 * (1.0 + std::abs(reference)))
+        std::cout << "Value differs at index " << i << ", output " << j << ": " << output(i, j) << ", expected " << reference << std::endl;
+    }
+  }
+
+  // Gradient and hessian must agree with centered finite differences
+  const NeuralNetworkGradient gradient(p_evaluation);
+  const NeuralNetworkHessian hessian(p_evaluation);
+  for (UnsignedInteger i = 0; i < input.getSize(); i += 7)
+  {
+    const Point x(input[i]);
+    const Matrix g(gradient.gradient(x));
+    const SymmetricTensor h(hessian.hessian(x));
+    for (UnsignedInteger k = 0; k < 6; ++k)
+    {
+      const Scalar step = 1.e-5;
+      Point xPlus(x);
+      xPlus[k] += step;
+      Point xMinus(x);
+      xMinus[k] -= step;
+      const Point valueDifference(evaluation(xPlus) - evaluation(xMinus));
+      const Matrix gradientDifference(gradient.gradient(xPlus) - gradient.gradient(xMinus));
+      for (UnsignedInteger j = 0; j < 2; ++j)
+      {
+        if (std::abs(g(k, j) - valueDifference[j] / (2.0 * step)) > 1.e-7)
+          std::cout << "Gradient differs at index " << i << ", component (" << k << ", " << j << ")" << std::endl;
+        for (UnsignedInteger l = 0; l < 6; ++l)
+          if (std::abs(h(k, l, j) - gradientDifference(l, j) / (2.0 * step)) > 1.e-7)
+            std::cout << "Hessian differs at index " << i << ", component (" << k << ", " << l << ", " << j << ")" << std::endl;
+      }
+    }
+  }
+
+  // Single precision uses the same sparse structure; float copies are only built for it
+  const UnsignedInteger nativeMemoryUsage = evaluation.getMemoryUsage();
+  const Point deviation(evaluation.computeSinglePrecisionDeviation(input));
+  std::cout << "Single precision copies counted once built = " << (evaluation.getMemoryUsage() > nativeMemoryUsage) << std::endl;
+  for (UnsignedInteger j = 0; j < 2; ++j)
+    if (deviation[j] > 1.e-5)
+      std::cout << "Single precision deviation " << deviation[j] << " is too large for output " << j << std::endl;
+
+  return 0;
+}
@@ -1,4 +1,9 @@
 #include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
 // OT includes
 #include <openturns/OT.hxx>
 
@@ -6,6 +11,8 @@
 #include "otpmml/PMMLDoc.hxx"
 #include "otpmml/PMMLNeuralNetwork.hxx"
 #include "otpmml/NeuralNetwork.hxx"
+#include "otpmml/ModelRegistry.hxx"
+#include "otpmml/LoadProfiler.hxx"
 
 using namespace OT;
 using namespace OTPMML;
@@ -21,6 +28,178 @@ int main()
   Function annFunction = NeuralNetwork("uranie_ann_poutre.pmml");
   std::cout << annFunction(reseau) << " expected value=46.5277" << std::endl;
 
+  Function symbolicFunction = NeuralNetwork("uranie_ann_poutre.pmml", "", NeuralNetwork::SYMBOLIC);
+  std::cout << symbolicFunction(reseau) << " expected value=46.5277" << std::endl;
+
+  // Native and symbolic evaluations must agree
+  const Sample input(DAT::Import("input_output.dat")[0]);
+  const Sample nativeOutput(annFunction(input));
+  const Sample symbolicOutput(symbolicFunction(input));
+  for (UnsignedInteger i = 0; i < input.getSize(); ++i)
+  {
+    if (std::abs(nativeOutput(i, 0) - symbolicOutput(i, 0)) > 1.e-10 * std::abs(symbolicOutput(i, 0)))
+    {
+      std::cout << "Significant differences found at index " << i << std::endl;
+      break;
+    }
+  }
+
+  // Analytical gradient and hessian must agree with centered finite differences
+  const NeuralNetwork::SymmetricTensorCollection hessians(NeuralNetwork("uranie_ann_poutre.pmml").hessian(input));
+  for (UnsignedInteger i = 0; i < input.getSize(); i += 10)
+  {
+    const Point x(input[i]);
+    const Matrix gradient(annFunction.gradient(x));
+    const SymmetricTensor hessian(annFunction.hessian(x));
+    for (UnsignedInteger k = 0; k < x.getDimension(); ++k)
+    {
+      const Scalar h = 1.e-5 * std::abs(x[k]);
+      Point xPlus(x);
+      xPlus[k] += h;
+      Point xMinus(x);
+      xMinus[k] -= h;
+      const Scalar finiteDifference = (annFunction(xPlus)[0] - annFunction(xMinus)[0]) / (2.0 * h);
+      if (std::abs(gradient(k, 0) - finiteDifference) > 1.e-6 * std::abs(gradient(k, 0)))
+        std::cout << "Significant gradient differences found at index " << i << ", component " << k << std::endl;
+      const Matrix gradientDifference(annFunction.gradient(xPlus) - annFunction.gradient(xMinus));
+      for (UnsignedInteger l = 0; l < x.getDimension(); ++l)
+      {
+        const Scalar scale = std::sqrt(std::abs(hessian(k, k, 0) * hessian(l, l, 0)));
+        if (std::abs(hessian(k, l, 0) - gradientDifference(l, 0) / (2.0 * h)) > 1.e-4 * scale)
+          std::cout << "Significant hessian differences found at index " << i << ", component (" << k << ", " << l << ")" << std::endl;
+        if (hessians[i](k, l, 0) != hessian(k, l, 0))
+          std::cout << "Sample hessian differs at index " << i << ", component (" << k << ", " << l << ")" << std::endl;
+      }
+    }
+  }
+
+  // Sample evaluation must not depend on blocks nor threads
+  NeuralNetwork network("uranie_ann_poutre.pmml");
+  Sample largeInput(0, input.getDimension());
+  for (UnsignedInteger i = 0; i < 37; ++i)
+    largeInput.add(input);
+  network.setNumberOfThreads(1);
+  const Sample serialOutput(network(largeInput));
+  const UnsignedInteger numberOfThreads[] = {0, 2, 3, 8};
+  const UnsignedInteger blockSizes[] = {1, 7, 256, 10000};
+  for (UnsignedInteger i = 0; i < 4; ++i)
+  {
+    network.setNumberOfThreads(numberOfThreads[i]);
+    network.setBlockSize(blockSizes[i]);
+    const Sample parallelOutput(network(largeInput));
+    for (UnsignedInteger j = 0; j < largeInput.getSize(); ++j)
+      if (parallelOutput(j, 0) != serialOutput(j, 0))
+      {
+        std::cout << "Parallel evaluation with " << numberOfThreads[i] << " threads differs at index " << j << std::endl;
+        break;
+      }
+  }
+
+  // Settings of a copy do not change the original network
+  NeuralNetwork networkCopy(network);
+  networkCopy.setNumberOfThreads(5);
+  networkCopy.setBlockSize(3);
+  if ((network.getNumberOfThreads() == 5) || (network.getBlockSize() == 3))
+    std::cout << "Settings of a copy are shared" << std::endl;
+  if ((networkCopy.getNumberOfThreads() != 5) || (networkCopy.getBlockSize() != 3) || !(networkCopy(largeInput) == serialOutput))
+    std::cout << "Settings of the copy are wrong" << std::endl;
+
+  // Single precision evaluation must stay close to the double precision one
+  NeuralNetwork singlePrecisionNetwork("uranie_ann_poutre.pmml", "", NeuralNetwork::SINGLE_PRECISION);
+  const Sample singlePrecisionOutput(singlePrecisionNetwork(largeInput));
+  const Point deviation(singlePrecisionNetwork.computeSinglePrecisionDeviation(largeInput));
+  Scalar maximumDeviation = 0.0;
+  Scalar maximumOutput = 0.0;
+  for (UnsignedInteger j = 0; j < largeInput.getSize(); ++j)
+  {
+    maximumDeviation = std::max(maximumDeviation, std::abs(singlePrecisionOutput(j, 0) - serialOutput(j, 0)));
+    maximumOutput = std::max(maximumOutput, std::abs(serialOutput(j, 0)));
+  }
+  if (deviation[0] != maximumDeviation)
+    std::cout << "Single precision deviation is " << deviation[0] << ", expected " << maximumDeviation << std::endl;
+  if (maximumDeviation > 1.e-5 * maximumOutput)
+    std::cout << "Single precision deviation " << maximumDeviation << " is too large" << std::endl;
+  if (singlePrecisionNetwork(input[0])[0] != singlePrecisionOutput(0, 0))
+    std::cout << "Single precision evaluation of a point differs" << std::endl;
+
+  // A network mapped from its cache must give the same results
+  // (the registry is cleared so that networks are not shared)
+  std::remove("uranie_ann_poutre.cache");
+  ModelRegistry::Clear();
+  const NeuralNetwork cachedNetwork("uranie_ann_poutre.pmml", "", NeuralNetwork::NATIVE, "uranie_ann_poutre.cache");
+  ModelRegistry::Clear();
+  const NeuralNetwork mappedNetwork("uranie_ann_poutre.pmml", "", NeuralNetwork::NATIVE, "uranie_ann_poutre.cache");
+  if (mappedNetwork.getName() != cachedNetwork.getName())
+    std::cout << "Cached network is named " << mappedNetwork.getName() << ", expected " << cachedNetwork.getName() << std::endl;
+  if (!(mappedNetwork(largeInput) == serialOutput))
+    std::cout << "Cached network evaluation differs" << std::endl;
+  if (!(mappedNetwork.getNeuralInputNames() == cachedNetwork.getNeuralInputNames()) || !(mappedNetwork.getNeuralOutputNames() == cachedNetwork.getNeuralOutputNames()))
+    std::cout << "Cached network fields are " << mappedNetwork.getNeuralInputNames() << " -> " << mappedNetwork.getNeuralOutputNames() << std::endl;
+
+  // A network built again from the same file shares the registered one, but not its settings
+  ModelRegistry::Clear();
+  NeuralNetwork registeredNetwork("uranie_ann_poutre.pmml");
+  registeredNetwork.setBlockSize(7);
+  const NeuralNetwork sharedNetwork("uranie_ann_poutre.pmml");
+  std::cout << "Registry hits=" << ModelRegistry::GetNumberOfHits() << " misses=" << ModelRegistry::GetNumberOfMisses() << " models=" << ModelRegistry::GetNumberOfModels() << std::endl;
+  if (sharedNetwork.getBlockSize() == registeredNetwork.getBlockSize())
+    std::cout << "Registered network settings are shared" << std::endl;
+  if (!(sharedNetwork(largeInput) == serialOutput))
+    std::cout << "Registered network evaluation differs" << std::endl;
+  std::cout << "Registered network inputs=" << sharedNetwork.getNeuralInputNames() << " outputs=" << sharedNetwork.getNeuralOutputNames() << std::endl;
+  ModelRegistry::SetCapacity(0);
+  const NeuralNetwork unregisteredNetwork("uranie_ann_poutre.pmml");
+  std::cout << "Registry models=" << ModelRegistry::GetNumberOfModels() << " after it has been disabled" << std::endl;
+
+  // A network read from memory
+  const PMMLBuffer buffer(PMMLBuffer::MapFile("uranie_ann_poutre.pmml"));
+  const String contents(buffer.getData(), buffer.getSize());
+  const NeuralNetwork bufferNetwork(PMMLBuffer(contents.data(), contents.size()));
+  if (!(bufferNetwork(largeInput) == serialOutput))
+    std::cout << "Buffer network evaluation differs" << std::endl;
+  try
+  {
+    const NeuralNetwork missingNetwork("missing.pmml");
+    std::cout << "Missing file has been read" << std::endl;
+  }
+  catch (const FileNotFoundException &)
+  {
+    std::cout << "Missing file is reported" << std::endl;
+  }
+
+  // Phases of a load; registry is still disabled, so that the network is read again
+  LoadProfiler::SetEnabled(true);
+  const NeuralNetwork profiledNetwork("uranie_ann_poutre.pmml", "ANNPoutre");
+  LoadProfiler::SetEnabled(false);
+  const LoadProfile profile(LoadProfiler::GetLastProfile());
+  std::cout << "Profiled load of " << profile.getCategory() << " " << profile.getModelName() << ", phases=" << LoadProfile::GetPhaseNames() << std::endl;
+  const Point wallTimes(profile.getWallTimes());
+  Bool allPhasesTimed = true;
+  for (UnsignedInteger i = 0; i < wallTimes.getDimension(); ++i)
+    allPhasesTimed = allPhasesTimed && (wallTimes[i] > 0.0);
+  std::cout << "All phases are timed = " << allPhasesTimed << std::endl;
+  const NeuralNetwork unprofiledNetwork("uranie_ann_poutre.pmml");
+  std::cout << "Profile is kept when profiling is disabled = " << (LoadProfiler::GetLastProfile().getModelName() == "ANNPoutre") << std::endl;
+
+  // A lazy network only reads its header, and is built once by the first threads evaluating it
+  const NeuralNetwork lazyNetwork("uranie_ann_poutre.pmml", "", NeuralNetwork::NATIVE, "", true);
+  std::cout << "Lazy network " << lazyNetwork.getName() << " inputs=" << lazyNetwork.getNeuralInputNames() << " outputs=" << lazyNetwork.getNeuralOutputNames()
+            << " layers=" << lazyNetwork.getLayerSizes() << " activations=" << lazyNetwork.getActivations() << std::endl;
+  std::cout << "Lazy network dimensions=" << lazyNetwork.getInputDimension() << "x" << lazyNetwork.getOutputDimension()
+            << " blockSize=" << lazyNetwork.getBlockSize() << " loaded=" << lazyNetwork.isLoaded() << std::endl;
+  std::vector<Sample> lazyOutputs(4);
+  std::vector<std::thread> lazyThreads;
+  for (UnsignedInteger i = 0; i < lazyOutputs.size(); ++i)
+    lazyThreads.push_back(std::thread([&lazyNetwork, &largeInput, &lazyOutputs, i]() { lazyOutputs[i] = lazyNetwork(largeInput); }));
+  for (UnsignedInteger i = 0; i < lazyThreads.size(); ++i)
+    lazyThreads[i].join();
+  for (UnsignedInteger i = 0; i < lazyOutputs.size(); ++i)
+    if (!(lazyOutputs[i] == serialOutput))
+      std::cout << "Lazy network evaluation differs in thread " << i << std::endl;
+  if (!(lazyNetwork.gradient(input[0]) == annFunction.gradient(input[0])) || !(lazyNetwork.hessian(input)[0] == hessians[0]))
+    std::cout << "Lazy network derivatives differ" << std::endl;
+  std::cout << "Lazy network loaded=" << lazyNetwork.isLoaded() << " after evaluation" << std::endl;
+
   return 0;
 }
 
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <thread>
+#include <vector>
 // OT includes
 #include <openturns/OT.hxx>
 
@@ -52,6 +54,51 @@ int main()
   Point y(nnet.getOutputsNormalizationFunction()(x1));
   std::cout << "y=" << y << std::endl;
 
+  // Same model read as a stream
+  PMMLNeuralNetwork streamed(PMMLDoc::StreamNeuralNetwork("uranie_ann_poutre.pmml", "ANNPoutre"));
+  std::cout << "Streamed weights of layer 0 are equal = " << (streamed.getWeightsAtLayer(0) == nnet.getWeightsAtLayer(0)) << std::endl;
+  std::cout << "Streamed bias of layer 1 are equal = " << (streamed.getBiasAtLayer(1) == nnet.getBiasAtLayer(1)) << std::endl;
+  std::cout << "Streamed inputs normalization is equal = " << (streamed.getInputsNormalization() == nnet.getInputsNormalization()) << std::endl;
+  std::cout << "Streamed name of neural input 2 = " << streamed.getNeuralInputName(2) << std::endl;
+
+  // Models are looked up by name in the document index, so any name is valid
+  std::cout << "Default neural network = " << doc.getNeuralNetwork().getModelName() << std::endl;
+  try
+  {
+    doc.getNeuralNetwork("ANN'Poutre");
+    std::cout << "Unknown neural network has been found" << std::endl;
+  }
+  catch (const InvalidArgumentException &)
+  {
+    std::cout << "Unknown neural network is reported" << std::endl;
+  }
+
+  // The same document and file can be read from several threads
+  const Matrix weights(nnet.getWeightsAtLayer(0));
+  std::vector<int> equal(4, 0);
+  std::vector<std::thread> threads;
+  for (UnsignedInteger i = 0; i < equal.size(); ++i)
+    threads.push_back(std::thread([&doc, &weights, &equal, i]()
+    {
+      const PMMLNeuralNetwork queried(doc.getNeuralNetwork("ANNPoutre"));
+      const PMMLNeuralNetwork read(PMMLDoc::StreamNeuralNetwork("uranie_ann_poutre.pmml"));
+      equal[i] = (queried.getWeightsAtLayer(0) == weights) && (read.getWeightsAtLayer(0) == weights);
+    }));
+  Bool allEqual = true;
+  for (UnsignedInteger i = 0; i < threads.size(); ++i)
+  {
+    threads[i].join();
+    allEqual = allEqual && equal[i];
+  }
+  std::cout << "Concurrent reads are equal = " << allEqual << std::endl;
+
+  // Models of several categories are looked up by name
+  PMMLDoc models("multiple_models.pmml");
+  std::cout << "Neural networks in multiple_models.pmml = " << models.getNeuralNetworkModelNames() << std::endl;
+  std::cout << "Regression models in multiple_models.pmml = " << models.getRegressionModelNames() << std::endl;
+  std::cout << "Second neural network = " << models.getNeuralNetwork("ANNPoutreBis").getModelName() << std::endl;
+  std::cout << "Regression model = " << models.getRegressionModel("Claims").getModelName() << std::endl;
+
   doc.reset();
   doc.write("clear.pmml");
 
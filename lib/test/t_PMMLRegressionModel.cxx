@@ -1,4 +1,6 @@
 #include <iostream>
+#include <fstream>
+#include <iterator>
 // OT includes
 #include <openturns/OT.hxx>
 
@@ -23,6 +25,15 @@ int main()
   std::cout << "   constant = " << leastSquares.getConstant() << std::endl;
   std::cout << "   linear = " << leastSquares.getLinear() << std::endl;
 
+  // Same model read from memory
+  std::ifstream file("linear_regression.pmml");
+  const String contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  const PMMLBuffer buffer(contents.data(), contents.size());
+  PMMLDoc bufferDoc(buffer);
+  std::cout << "Number of regression models in buffer = " << bufferDoc.getNumberOfRegressionModels() << std::endl;
+  const LinearLeastSquares bufferLeastSquares(RegressionModel(buffer).getLinearLeastSquares());
+  std::cout << "   constant = " << bufferLeastSquares.getConstant() << std::endl;
+
   return 0;
 }
 
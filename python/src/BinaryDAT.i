@@ -0,0 +1,9 @@
+// SWIG file BinaryDAT.i
+
+%{
+#include "otpmml/BinaryDAT.hxx"
+%}
+
+%include BinaryDAT_doc.i
+
+%include otpmml/BinaryDAT.hxx
@@ -0,0 +1,24 @@
+// SWIG file DATReader.i
+
+%{
+#include "otpmml/DATReader.hxx"
+%}
+
+%include DATReader_doc.i
+
+%include otpmml/DATReader.hxx
+namespace OTPMML { %extend DATReader {
+
+DATReader(const DATReader & other) { return new OTPMML::DATReader(other); }
+
+%pythoncode %{
+def __iter__(self):
+    return self
+
+def __next__(self):
+    if not self.hasNext():
+        raise StopIteration
+    batch = self.getNext()
+    return batch[0], batch[1]
+%}
+} }
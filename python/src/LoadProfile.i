@@ -0,0 +1,10 @@
+// SWIG file LoadProfile.i
+
+%{
+#include "otpmml/LoadProfile.hxx"
+%}
+
+%include LoadProfile_doc.i
+
+%include otpmml/LoadProfile.hxx
+namespace OTPMML { %extend LoadProfile { LoadProfile(const LoadProfile & other) { return new OTPMML::LoadProfile(other); } } }
@@ -0,0 +1,9 @@
+// SWIG file LoadProfiler.i
+
+%{
+#include "otpmml/LoadProfiler.hxx"
+%}
+
+%include LoadProfiler_doc.i
+
+%include otpmml/LoadProfiler.hxx
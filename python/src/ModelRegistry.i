@@ -0,0 +1,16 @@
+// SWIG file ModelRegistry.i
+
+%{
+#include "otpmml/ModelRegistry.hxx"
+%}
+
+%include ModelRegistry_doc.i
+
+// Keys and registered models are only used by the model constructors
+%ignore OTPMML::ModelRegistry::GetKey;
+%ignore OTPMML::ModelRegistry::FindNeuralNetwork;
+%ignore OTPMML::ModelRegistry::AddNeuralNetwork;
+%ignore OTPMML::ModelRegistry::FindRegressionModel;
+%ignore OTPMML::ModelRegistry::AddRegressionModel;
+
+%include otpmml/ModelRegistry.hxx
@@ -0,0 +1,10 @@
+// SWIG file ModelSet.i
+
+%{
+#include "otpmml/ModelSet.hxx"
+%}
+
+%include ModelSet_doc.i
+
+%include otpmml/ModelSet.hxx
+namespace OTPMML { %extend ModelSet { ModelSet(const ModelSet & other) { return new OTPMML::ModelSet(other); } } }
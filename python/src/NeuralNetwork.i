@@ -2,9 +2,12 @@
 
 %{
 #include "otpmml/NeuralNetwork.hxx"
+#include <openturns/SymmetricTensor.hxx>
 %}
 
 %include NeuralNetwork_doc.i
 
+%template(SymmetricTensorCollection) OT::Collection<OT::SymmetricTensor>;
+
 %include otpmml/NeuralNetwork.hxx
 namespace OTPMML { %extend NeuralNetwork { NeuralNetwork(const NeuralNetwork & other) { return new OTPMML::NeuralNetwork(other); } } }
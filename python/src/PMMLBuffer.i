@@ -0,0 +1,35 @@
+// SWIG file PMMLBuffer.i
+
+%{
+#include "otpmml/PMMLBuffer.hxx"
+%}
+
+%include PMMLBuffer_doc.i
+
+// Bytes are given by a Python bytes object, or by a str object encoded in UTF-8;
+// the default (char *STRING, size_t LENGTH) typemap rejects bytes with Python 3
+%typemap(in) (const char * data, const std::size_t size) {
+  char * data = NULL;
+  Py_ssize_t size = 0;
+  if (PyBytes_Check($input))
+  {
+    if (PyBytes_AsStringAndSize($input, &data, &size) < 0) SWIG_fail;
+  }
+  else if (PyUnicode_Check($input))
+  {
+    const char * utf8 = PyUnicode_AsUTF8AndSize($input, &size);
+    if (!utf8) SWIG_fail;
+    data = const_cast<char *>(utf8);
+  }
+  else
+    SWIG_exception_fail(SWIG_TypeError, "PMMLBuffer contents must be bytes or str");
+  $1 = data;
+  $2 = static_cast<std::size_t>(size);
+}
+%typemap(typecheck, precedence=SWIG_TYPECHECK_STRING) (const char * data, const std::size_t size) {
+  $1 = (PyBytes_Check($input) || PyUnicode_Check($input)) ? 1 : 0;
+}
+%ignore OTPMML::PMMLBuffer::getData;
+
+%include otpmml/PMMLBuffer.hxx
+namespace OTPMML { %extend PMMLBuffer { PMMLBuffer(const PMMLBuffer & other) { return new OTPMML::PMMLBuffer(other); } } }
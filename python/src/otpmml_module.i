@@ -23,7 +23,14 @@
 // The new classes
 %include otpmml/OTPMMLprivate.hxx
 %include DAT.i
+%include DATReader.i
+%include BinaryDAT.i
+%include LoadProfile.i
+%include LoadProfiler.i
+%include PMMLBuffer.i
 %include RegressionModel.i
 %include NeuralNetwork.i
+%include ModelSet.i
+%include ModelRegistry.i
 
 
@@ -0,0 +1,15 @@
+#! /usr/bin/env python
+
+import otpmml
+
+samples = otpmml.DAT.Import("input_output.dat")
+
+# Convert the text file, then read it back
+otpmml.BinaryDAT.ConvertFromDAT("input_output.dat", "input_output_py.bin")
+print("column names=", otpmml.BinaryDAT.GetColumnNames("input_output_py.bin"))
+input_sample, output_sample = tuple(otpmml.BinaryDAT.Import("input_output_py.bin"))
+print("same samples=", input_sample == samples[0] and output_sample == samples[1])
+
+# Read only the output column
+output_only = otpmml.BinaryDAT.Import("input_output_py.bin", [4])
+print("output column=", output_only.getDescription(), output_only == samples[1])
@@ -0,0 +1,19 @@
+#! /usr/bin/env python
+
+import openturns as ot
+import otpmml
+
+samples = otpmml.DAT.Import("input_output.dat")
+
+# Read the file by batches of 30 rows
+reader = otpmml.DATReader("input_output.dat", 30)
+print("input description=", reader.getInputDescription())
+print("output description=", reader.getOutputDescription())
+input_sample = ot.Sample(0, reader.getInputDimension())
+output_sample = ot.Sample(0, 1)
+for batch_input, batch_output in reader:
+    print("batch size=", batch_input.getSize())
+    input_sample.add(batch_input)
+    output_sample.add(batch_output)
+print("rows read=", reader.getRowsNumber())
+print("same as DAT.Import=", input_sample == samples[0] and output_sample == samples[1])
@@ -0,0 +1,27 @@
+#! /usr/bin/env python
+
+import otpmml
+
+# Building a model again from the same file shares the registered one
+otpmml.ModelRegistry.Clear()
+capacity = otpmml.ModelRegistry.GetCapacity()
+network = otpmml.NeuralNetwork("uranie_ann_poutre.pmml")
+sharedNetwork = otpmml.NeuralNetwork("uranie_ann_poutre.pmml")
+print("hits=", otpmml.ModelRegistry.GetNumberOfHits())
+print("misses=", otpmml.ModelRegistry.GetNumberOfMisses())
+print("models=", otpmml.ModelRegistry.GetNumberOfModels())
+print("memory used=", otpmml.ModelRegistry.GetMemoryUsage() > 0)
+x = [3.048020426e+00, 4.429896757e+04, 2.550648980e+02, 3.711170093e+02]
+print("same evaluation=", network(x) == sharedNetwork(x))
+
+# A capacity smaller than a model evicts it
+otpmml.ModelRegistry.SetCapacity(1)
+otpmml.RegressionModel("linear_regression.pmml")
+print("evictions=", otpmml.ModelRegistry.GetNumberOfEvictions() > 0)
+print("models within capacity=", otpmml.ModelRegistry.GetMemoryUsage() <= 1)
+
+# Clear removes the models and resets the statistics
+otpmml.ModelRegistry.Clear()
+print("after clear hits=", otpmml.ModelRegistry.GetNumberOfHits(), "misses=",
+      otpmml.ModelRegistry.GetNumberOfMisses(), "models=", otpmml.ModelRegistry.GetNumberOfModels())
+otpmml.ModelRegistry.SetCapacity(capacity)
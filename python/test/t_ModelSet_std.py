@@ -0,0 +1,15 @@
+#! /usr/bin/env python
+
+import otpmml
+
+# Read every model of the file at once
+models = otpmml.ModelSet("multiple_models.pmml")
+print("neural networks=", models.getNumberOfNeuralNetworks())
+print("regression models=", models.getNumberOfRegressionModels())
+functions = models.getFunctions()
+print("functions=", len(functions))
+
+network = models.getNeuralNetwork("ANNPoutreBis")
+reference = otpmml.NeuralNetwork("uranie_ann_poutre.pmml")
+x = [3.048020426e+00, 4.429896757e+04, 2.550648980e+02, 3.711170093e+02]
+print("same evaluation=", network(x) == reference(x))
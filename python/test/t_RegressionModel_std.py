@@ -7,3 +7,21 @@ least_squares = model.getLinearLeastSquares()
 print("Linear regression:")
 print("  constant=", least_squares.getConstant())
 print("  linear=", least_squares.getLinear())
+
+# Same model read from memory
+with open("linear_regression.pmml", "rb") as f:
+    buffer = otpmml.PMMLBuffer(f.read())
+model = otpmml.RegressionModel(buffer)
+print("  constant from buffer=", model.getLinearLeastSquares().getConstant())
+with open("linear_regression.pmml", "r") as f:
+    model = otpmml.RegressionModel(otpmml.PMMLBuffer(f.read()))
+print("  constant from str=", model.getLinearLeastSquares().getConstant())
+
+# Phases of the load of a model
+otpmml.LoadProfiler.SetEnabled(True)
+model = otpmml.RegressionModel(buffer)
+otpmml.LoadProfiler.SetEnabled(False)
+profile = otpmml.LoadProfiler.GetLastProfile()
+print("  profiled category=", profile.getCategory())
+print("  profiled phases=", otpmml.LoadProfile.GetPhaseNames())
+print("  positive total time=", profile.getTotalWallTime() > 0.0)